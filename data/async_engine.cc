@@ -0,0 +1,128 @@
+#include "src/async_engine.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "src/board.h"
+#include "src/common.h"
+#include "src/engine.h"
+#include "src/options.h"
+#include "src/thread_pool.h"
+
+namespace checkers_style_game {
+
+void AsyncEngine::EventQueue::OnGameStarted(int board_size) {
+  Push([board_size](Engine::Observer& observer) {
+    observer.OnGameStarted(board_size);
+  });
+}
+
+void AsyncEngine::EventQueue::OnGameUpdated(Side side_to_move,
+                                            const Board::Data& data) {
+  Push([side_to_move, data](Engine::Observer& observer) {
+    observer.OnGameUpdated(side_to_move, data);
+  });
+}
+
+void AsyncEngine::EventQueue::OnGameEnded(Side side_that_wins) {
+  Push([side_that_wins](Engine::Observer& observer) {
+    observer.OnGameEnded(side_that_wins);
+  });
+}
+
+std::deque<AsyncEngine::EventQueue::Event>
+AsyncEngine::EventQueue::TakeAll() {
+  std::deque<Event> events;
+  std::lock_guard<std::mutex> lock{mutex_};
+  events.swap(events_);
+  return events;
+}
+
+void AsyncEngine::EventQueue::Push(Event event) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  events_.push_back(std::move(event));
+}
+
+AsyncEngine::Ptr AsyncEngine::Create(const Engine::Observer& observer,
+                                     const Engine::Logger& logger,
+                                     ThreadPool& pool) {
+  return Ptr{new AsyncEngine{observer, logger, pool}};
+}
+
+AsyncEngine::AsyncEngine(const Engine::Observer& observer,
+                         const Engine::Logger& logger, ThreadPool& pool)
+    : observer_{const_cast<Engine::Observer&>(observer)}, pool_{pool},
+      engine_{Engine::Create(events_, logger)} {}
+
+AsyncEngine::~AsyncEngine() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  idle_cv_.wait(lock, [this] { return !is_draining_; });
+}
+
+std::future<bool> AsyncEngine::StartGameAsync(const Options* options) {
+  auto copy = options ? *options : Options{};
+  return Post([copy](Engine& engine) { return engine.StartGame(&copy); });
+}
+
+std::future<bool> AsyncEngine::TryAtAsync(int x, int y) {
+  return Post([x, y](Engine& engine) { return engine.TryAt(x, y); });
+}
+
+std::future<bool> AsyncEngine::MoveAsync(int x, int y, MoveDirection dir) {
+  return Post([x, y, dir](Engine& engine) { return engine.Move(x, y, dir); });
+}
+
+std::future<bool> AsyncEngine::TakeAsync(int x, int y, MoveDirection dir) {
+  return Post([x, y, dir](Engine& engine) { return engine.Take(x, y, dir); });
+}
+
+std::future<bool> AsyncEngine::RevertAsync() {
+  return Post([](Engine& engine) { return engine.Revert(); });
+}
+
+int AsyncEngine::PollEvents() {
+  auto events = events_.TakeAll();
+  for (auto& event : events) {
+    event(observer_);
+  }
+  return static_cast<int>(events.size());
+}
+
+std::future<bool> AsyncEngine::Post(std::function<bool(Engine&)> call) {
+  auto task = std::make_shared<std::packaged_task<bool()>>(
+      [this, call = std::move(call)] { return call(*engine_); });
+  auto result = task->get_future();
+  bool is_idle{};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    calls_.emplace_back([task] { (*task)(); });
+    is_idle = !is_draining_;
+    is_draining_ = true;
+  }
+  if (is_idle) {
+    pool_.Submit([this] { Drain(); });
+  }
+  return result;
+}
+
+void AsyncEngine::Drain() {
+  for (;;) {
+    std::function<void()> call;
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (calls_.empty()) {
+        is_draining_ = false;
+        idle_cv_.notify_all();
+        return;
+      }
+      call = std::move(calls_.front());
+      calls_.pop_front();
+    }
+    call();
+  }
+}
+
+}  // namespace checkers_style_game
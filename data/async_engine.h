@@ -0,0 +1,89 @@
+#ifndef SRC_ASYNC_ENGINE_H_
+#define SRC_ASYNC_ENGINE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include "src/board.h"
+#include "src/common.h"
+#include "src/engine.h"
+#include "src/options.h"
+#include "src/thread_pool.h"
+
+namespace checkers_style_game {
+
+// Asynchronous facade of Engine. Calls return at once with a future of the
+// result of the respective Engine call, which runs together with any
+// computer replies on a ThreadPool. Calls of one AsyncEngine run one after
+// another in the order of submission; different AsyncEngines may share the
+// pool and run in parallel.
+//
+// Observer notifications are queued and only delivered by PollEvents, on
+// the thread which calls it, e.g. the UI thread. The Logger is called from
+// the pool threads.
+class AsyncEngine final {
+ public:
+  using Ptr = std::unique_ptr<AsyncEngine>;
+
+  static Ptr Create(const Engine::Observer& observer,
+                    const Engine::Logger& logger, ThreadPool& pool);
+
+  // Waits for the submitted calls to complete.
+  ~AsyncEngine();
+
+  AsyncEngine(const AsyncEngine&) = delete;
+  AsyncEngine& operator=(const AsyncEngine&) = delete;
+
+  std::future<bool> StartGameAsync(const Options* options);
+  std::future<bool> TryAtAsync(int x, int y);
+  std::future<bool> MoveAsync(int x, int y, MoveDirection dir);
+  std::future<bool> TakeAsync(int x, int y, MoveDirection dir);
+  std::future<bool> RevertAsync();
+
+  // Delivers the queued notifications to the observer. Returns their
+  // number.
+  int PollEvents();
+
+ private:
+  // Observer of the wrapped Engine, which records notifications.
+  class EventQueue final : public Engine::Observer {
+   public:
+    using Event = std::function<void(Engine::Observer&)>;
+
+    void OnGameStarted(int board_size) override;
+    void OnGameUpdated(Side side_to_move, const Board::Data& data) override;
+    void OnGameEnded(Side side_that_wins) override;
+
+    std::deque<Event> TakeAll();
+
+   private:
+    void Push(Event event);
+
+    std::mutex mutex_;
+    std::deque<Event> events_;
+  };
+
+  AsyncEngine(const Engine::Observer& observer, const Engine::Logger& logger,
+              ThreadPool& pool);
+
+  std::future<bool> Post(std::function<bool(Engine&)> call);
+  void Drain();
+
+  Engine::Observer& observer_;
+  ThreadPool& pool_;
+  EventQueue events_;
+  Engine::Ptr engine_;
+
+  std::mutex mutex_;
+  std::condition_variable idle_cv_;
+  std::deque<std::function<void()>> calls_;
+  bool is_draining_{};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_ASYNC_ENGINE_H_
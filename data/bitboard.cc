@@ -0,0 +1,8 @@
+#include "src/bitboard.h"
+
+namespace checkers_style_game {
+
+template class BasicBitBoard<8>;
+template class BasicBitBoard<10>;
+
+}  // namespace checkers_style_game
@@ -0,0 +1,340 @@
+#ifndef SRC_BITBOARD_H_
+#define SRC_BITBOARD_H_
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "src/board.h"
+#include "src/common.h"
+#include "src/config.h"
+#include "src/coord.h"
+#include "src/geometry.h"
+#include "src/move_list.h"
+#include "src/zobrist.h"
+
+namespace checkers_style_game {
+
+// Board backend, which keeps the light, dark and king occupancy as bitmasks.
+// Square (x, y) maps to bit (x - 1) * kSize + (y - 1), thus the ascending
+// bit order follows the iteration order of Board. The Zobrist key of the
+// piece placement is maintained incrementally by Put, Remove and Relocate.
+template <int kSize>
+class BasicBitBoard final {
+ public:
+  using Geometry = checkers_style_game::Geometry<kSize>;
+  using Zobrist = checkers_style_game::Zobrist<kSize>;
+  using MoveList = BasicMoveList<kSize>;
+  using Mask = std::conditional_t<(Geometry::kNumSquares <= 64),
+                                  std::uint64_t, unsigned __int128>;
+
+  static constexpr int kNumSquares = Geometry::kNumSquares;
+  static constexpr auto& kDirections = Geometry::kDirections;
+
+  static constexpr int ToSquare(int x, int y) {
+    return (x - 1) * kSize + (y - 1);
+  }
+  static Coord ToCoord(int square) {
+    return Coord{square / kSize + 1, square % kSize + 1};
+  }
+  static constexpr Mask ToMask(int square) { return Mask{1} << square; }
+
+  static constexpr Mask Shift(Mask mask, MoveDirection dir) {
+    if (MoveDirection::kUnset == dir) {
+      return 0;
+    }
+    auto i = Geometry::ToDirectionIndex(dir);
+    auto delta = Geometry::kDx[i] * kSize + Geometry::kDy[i];
+    mask &= (Geometry::kDy[i] < 0) ? kNotLeftColumn : kNotRightColumn;
+    return (delta < 0) ? (mask >> -delta) : ((mask << delta) & kBoardMask);
+  }
+
+  static constexpr int PopCount(Mask mask) {
+    if constexpr (sizeof(Mask) > sizeof(std::uint64_t)) {
+      return __builtin_popcountll(static_cast<std::uint64_t>(mask)) +
+             __builtin_popcountll(static_cast<std::uint64_t>(mask >> 64));
+    } else {
+      return __builtin_popcountll(mask);
+    }
+  }
+
+  static constexpr int PopLowest(Mask& mask) {
+    int square{};
+    if constexpr (sizeof(Mask) > sizeof(std::uint64_t)) {
+      auto low = static_cast<std::uint64_t>(mask);
+      square = low ? __builtin_ctzll(low) :
+          64 + __builtin_ctzll(static_cast<std::uint64_t>(mask >> 64));
+    } else {
+      square = __builtin_ctzll(mask);
+    }
+    mask &= mask - 1;
+    return square;
+  }
+
+  // Board always has Config::kBoardSize rows, so only the backend of that
+  // size may mirror it. Being a template keeps the other sizes compiling.
+  template <int kBoardSize = Config::kBoardSize>
+  void Reset(const Board& board);
+
+  void Put(int square, Side side, Level level);
+  void Remove(int square);
+  void Relocate(int from, int to);
+
+  constexpr Mask pieces(Side side) const {
+    return (side == Side::kLight) ? light_ :
+           (side == Side::kDark) ? dark_ : Mask{};
+  }
+  constexpr Mask pieces(Side side, Level level) const {
+    return pieces(side) & ((level == Level::kKing) ? kings_ : ~kings_);
+  }
+  constexpr Mask kings() const { return kings_; }
+  constexpr Mask empty() const { return kBoardMask & ~(light_ | dark_); }
+  constexpr typename Zobrist::Key hash() const { return hash_; }
+
+  // Pieces of side, which may step in dir without regard to the side to move.
+  Mask GetMovers(Side side, MoveDirection dir) const {
+    auto targets = Shift(GetHeading(side, dir), dir) & empty();
+    return Shift(targets, Geometry::Opposite(dir));
+  }
+
+  // Pieces of side, which may jump over an opponent's piece in dir.
+  Mask GetTakers(Side side, MoveDirection dir) const {
+    auto targets = Shift(Shift(GetHeading(side, dir), dir) &
+                         pieces(Reverse(side)), dir) & empty();
+    auto back = Geometry::Opposite(dir);
+    return Shift(Shift(targets, back), back);
+  }
+
+  bool CanMove(Side side) const;
+  bool CanTake(Side side) const;
+  int GetTakesCount(Side side) const;
+
+  // Counts the (man, direction) pairs of side, which start a path of moves
+  // to the last row, where no position along the way (except the last one)
+  // lets the opponent take, while all other pieces stay in place. Paths are
+  // memoized per man, so the cost is bounded by men times squares.
+  int CountPromoPaths(Side side) const;
+
+  // Append the moves, respectively the takes, of side to moves, ordered by
+  // square and then by direction.
+  void GenerateMoves(Side side, MoveList& moves) const;
+  void GenerateTakes(Side side, MoveList& moves) const;
+
+ private:
+  static constexpr Mask GetColumnMask(int y) {
+    Mask mask{};
+    for (int x{1}; x <= kSize; ++x) {
+      mask |= ToMask(ToSquare(x, y));
+    }
+    return mask;
+  }
+
+  static constexpr Mask kBoardMask =
+      (kNumSquares == 8 * sizeof(Mask)) ? ~Mask{} :
+                                          (Mask{1} << kNumSquares) - 1;
+  static constexpr Mask kNotLeftColumn = ~GetColumnMask(1);
+  static constexpr Mask kNotRightColumn = ~GetColumnMask(kSize);
+
+  template <typename GetSources>
+  static void Generate(GetSources get_sources, bool is_take, MoveList& moves);
+
+  // Pieces of side, which are allowed to head in dir by their level.
+  Mask GetHeading(Side side, MoveDirection dir) const {
+    auto own = pieces(side);
+    return Geometry::IsForward(side, dir) ? own : (own & kings_);
+  }
+
+  // Zobrist key of the piece at square, or zero for an empty square.
+  typename Zobrist::Key GetPieceKey(int square) const {
+    auto mask = ToMask(square);
+    auto level = (kings_ & mask) ? Level::kKing : Level::kMan;
+    return (light_ & mask) ? Zobrist::GetPieceKey(Side::kLight, level, square) :
+           (dark_ & mask) ? Zobrist::GetPieceKey(Side::kDark, level, square) :
+                            typename Zobrist::Key{};
+  }
+
+  Mask light_{};
+  Mask dark_{};
+  Mask kings_{};
+  typename Zobrist::Key hash_{};
+};
+
+template <int kSize>
+template <int kBoardSize>
+void BasicBitBoard<kSize>::Reset(const Board& board) {
+  static_assert(kBoardSize == kSize, "Board does not match the board size");
+  light_ = dark_ = kings_ = 0;
+  hash_ = 0;
+  for (const auto& row : board) {
+    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
+      auto piece = *piece_it;
+      if (piece) {
+        Coord coord = piece_it.GetCoord();
+        Put(ToSquare(coord.x(), coord.y()), piece->side(), piece->level());
+      }
+    }
+  }
+}
+
+template <int kSize>
+void BasicBitBoard<kSize>::Put(int square, Side side, Level level) {
+  auto mask = ToMask(square);
+  if (side == Side::kLight) {
+    light_ |= mask;
+  } else if (side == Side::kDark) {
+    dark_ |= mask;
+  } else {
+    return;
+  }
+  if (level == Level::kKing) {
+    kings_ |= mask;
+  }
+  hash_ ^= Zobrist::GetPieceKey(side, level, square);
+}
+
+template <int kSize>
+void BasicBitBoard<kSize>::Remove(int square) {
+  hash_ ^= GetPieceKey(square);
+  auto mask = ~ToMask(square);
+  light_ &= mask;
+  dark_ &= mask;
+  kings_ &= mask;
+}
+
+template <int kSize>
+void BasicBitBoard<kSize>::Relocate(int from, int to) {
+  auto from_key = GetPieceKey(from);
+  auto from_mask = ToMask(from);
+  auto to_mask = ToMask(to);
+  auto move = [from_mask, to_mask](Mask& bits) {
+    if (bits & from_mask) {
+      bits = (bits & ~from_mask) | to_mask;
+    }
+  };
+  move(light_);
+  move(dark_);
+  move(kings_);
+  hash_ ^= from_key ^ GetPieceKey(to);
+}
+
+template <int kSize>
+bool BasicBitBoard<kSize>::CanMove(Side side) const {
+  for (auto dir : kDirections) {
+    if (GetMovers(side, dir)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int kSize>
+bool BasicBitBoard<kSize>::CanTake(Side side) const {
+  for (auto dir : kDirections) {
+    if (GetTakers(side, dir)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int kSize>
+int BasicBitBoard<kSize>::GetTakesCount(Side side) const {
+  int count{};
+  for (auto dir : kDirections) {
+    count += PopCount(GetTakers(side, dir));
+  }
+  return count;
+}
+
+template <int kSize>
+int BasicBitBoard<kSize>::CountPromoPaths(Side side) const {
+  enum class Reach : std::int8_t { kUnknown, kYes, kNo };
+
+  int count{};
+  auto men = pieces(side, Level::kMan);
+  while (men) {
+    auto from = PopLowest(men);
+    auto scratch = *this;
+    scratch.Remove(from);
+    std::array<Reach, kNumSquares> memo{};
+    auto reaches = [side, &scratch, &memo](auto& self, int square) -> bool {
+      if (Geometry::IsEdgeRow(square / kSize + 1)) {
+        return true;
+      }
+      auto& reach = memo[square];
+      if (reach == Reach::kUnknown) {
+        scratch.Put(square, side, Level::kMan);
+        auto is_safe = !scratch.CanTake(Reverse(side));
+        scratch.Remove(square);
+        reach = Reach::kNo;
+        for (auto dir : kDirections) {
+          if (!is_safe) {
+            break;
+          }
+          if (!Geometry::IsForward(side, dir)) {
+            continue;
+          }
+          auto next = Shift(ToMask(square), dir) & scratch.empty();
+          if (next && self(self, PopLowest(next))) {
+            reach = Reach::kYes;
+            break;
+          }
+        }
+      }
+      return reach == Reach::kYes;
+    };
+    for (auto dir : kDirections) {
+      if (!Geometry::IsForward(side, dir)) {
+        continue;
+      }
+      auto next = Shift(ToMask(from), dir) & scratch.empty();
+      if (next && reaches(reaches, PopLowest(next))) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+template <int kSize>
+void BasicBitBoard<kSize>::GenerateMoves(Side side, MoveList& moves) const {
+  Generate([this, side](MoveDirection dir) { return GetMovers(side, dir); },
+           false, moves);
+}
+
+template <int kSize>
+void BasicBitBoard<kSize>::GenerateTakes(Side side, MoveList& moves) const {
+  Generate([this, side](MoveDirection dir) { return GetTakers(side, dir); },
+           true, moves);
+}
+
+template <int kSize>
+template <typename GetSources>
+void BasicBitBoard<kSize>::Generate(GetSources get_sources, bool is_take,
+                                    MoveList& moves) {
+  Mask sources[Geometry::kNumDirections];
+  Mask all_sources{};
+  for (int i{}; i < Geometry::kNumDirections; ++i) {
+    sources[i] = get_sources(kDirections[i]);
+    all_sources |= sources[i];
+  }
+  while (all_sources) {
+    auto square = PopLowest(all_sources);
+    auto mask = ToMask(square);
+    for (int i{}; i < Geometry::kNumDirections; ++i) {
+      if (sources[i] & mask) {
+        moves.push_back(MoveRecord{static_cast<std::uint8_t>(square),
+                             kDirections[i], is_take});
+      }
+    }
+  }
+}
+
+extern template class BasicBitBoard<8>;
+extern template class BasicBitBoard<10>;
+
+using BitBoard = BasicBitBoard<Config::kBoardSize>;
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_BITBOARD_H_
@@ -1,50 +1,142 @@
 #include "src/engine.h"
 
 #include <algorithm>
+#include <atomic>
 #include <bitset>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <typeinfo>
 #include <utility>
 
+#include "src/bitboard.h"
 #include "src/board.h"
 #include "src/command.h"
 #include "src/common.h"
 #include "src/config.h"
 #include "src/coord.h"
+#include "src/flat_history_item.h"
 #include "src/history_item.h"
+#include "src/mailbox.h"
+#include "src/move_list.h"
 #include "src/move_command.h"
 #include "src/take_command.h"
 #include "src/options.h"
+#include "src/ponderer.h"
+#include "src/position.h"
+#include "src/search.h"
+#include "src/tablebase_prober.h"
+#include "src/transposition_table.h"
 
 namespace checkers_style_game {
 
-class Client final : public Engine::Observer, public Engine::Logger {
- public:
-  explicit Client(Side side_to_move) : side_to_move_{side_to_move} {}
+namespace {
 
-  void Reset() {
-    side_that_wins_ = Side::kUnset;
+// Marks all squares stale, i.e. the board backends need a full reset.
+constexpr BitBoard::Mask kAllSquares = ~BitBoard::Mask{};
+
+std::list<Coord> ToCoords(BitBoard::Mask mask) {
+  std::list<Coord> coords;
+  while (mask) {
+    coords.push_back(BitBoard::ToCoord(BitBoard::PopLowest(mask)));
+  }
+  return coords;
+}
+
+// Squares, which a command at coord in dir may change: the one it starts
+// from, the one it jumps over and the one it lands on.
+BitBoard::Mask GetCommandSquares(const Coord& coord, MoveDirection dir) {
+  BitBoard::Mask squares{};
+  for (int distance{}; distance <= 2; ++distance) {
+    auto x = coord.x() + distance * Dx(dir);
+    auto y = coord.y() + distance * Dy(dir);
+    if (BitBoard::Geometry::IsInside(x, y)) {
+      squares |= BitBoard::ToMask(BitBoard::ToSquare(x, y));
+    }
   }
+  return squares;
+}
 
-  Side side_to_move() const { return side_to_move_; }
-  Side side_that_wins() const { return side_that_wins_; }
+// Normalizes the size argument of GetHistory/ExportHistory, where zero
+// means the whole history and negative sizes count as positive ones.
+int ToHistorySize(int size, std::size_t history_size) {
+  size = (size < 0) ? -size : (size == 0) ? history_size : size;
+  return std::min(size, static_cast<int>(history_size));
+}
+
+HistoryItem ToHistoryItem(const Command& cmd) {
+  return HistoryItem{cmd.coord().x(), cmd.coord().y(), cmd.direction(),
+                     cmd.side_to_move(), cmd.num_kings(), cmd.num_men(),
+                     cmd.num_seq_moves(), cmd.num_promo_paths()};
+}
 
- private:
-  void Log(Level, const std::string&) override {}
-  void OnGameStarted(int) override {}
-  void OnGameUpdated(Side, const Board::Data&) override {}
-  void OnGameEnded(Side side_that_wins) override {
-    side_that_wins_ = side_that_wins;
+FlatHistoryItem ToFlatHistoryItem(const Command& cmd) {
+  auto get = [](const std::map<Side, int>& counts, Side side) {
+    auto it = counts.find(side);
+    return (it != counts.end()) ? it->second : 0;
+  };
+  FlatHistoryItem item;
+  item.x = cmd.coord().x();
+  item.y = cmd.coord().y();
+  item.direction = cmd.direction();
+  item.side_to_move = cmd.side_to_move();
+  item.num_seq_moves = cmd.num_seq_moves();
+  for (auto side : {Side::kLight, Side::kDark}) {
+    auto i = FlatHistoryItem::ToIndex(side);
+    item.num_kings[i] = get(cmd.num_kings(), side);
+    item.num_men[i] = get(cmd.num_men(), side);
+    item.num_promo_paths[i] = get(cmd.num_promo_paths(), side);
+  }
+  return item;
+}
+
+// Limits of the search, which plays the turns of the computers.
+Search::Limits ToComputerLimits(const Options& options) {
+  Search::Limits limits;
+  limits.depth = options.computer_depth;
+  limits.nodes = options.computer_nodes;
+  limits.num_threads = options.computer_threads;
+  return limits;
+}
+
+// Whether bitboard and mailbox mirror every square of board.
+[[maybe_unused]] bool IsMirrored(const Board& board,
+                                 const BitBoard& bitboard,
+                                 const Mailbox& mailbox) {
+  for (int square{}; square < BitBoard::kNumSquares; ++square) {
+    auto coord = BitBoard::ToCoord(square);
+    const Piece* piece = board(coord);
+    auto mask = BitBoard::ToMask(square);
+    auto side = (bitboard.pieces(Side::kLight) & mask) ? Side::kLight :
+                (bitboard.pieces(Side::kDark) & mask) ? Side::kDark :
+                                                        Side::kUnset;
+    auto is_king = (bitboard.kings() & mask) != 0;
+    if ((side != (piece ? piece->side() : Side::kUnset)) ||
+        (piece && (is_king != (piece->level() == Level::kKing)))) {
+      return false;
+    }
+    Mailbox cells;
+    auto index = Mailbox::ToIndex(coord.x(), coord.y());
+    cells.Set(index, piece);
+    if (cells[index] != mailbox[index]) {
+      return false;
+    }
   }
+  return true;
+}
+
+bool IsTake(const Command& cmd) {
+  return dynamic_cast<const TakeCommand*>(&cmd) != nullptr;
+}
 
-  Side side_to_move_{Side::kUnset};
-  Side side_that_wins_{Side::kUnset};
-};
+}  // namespace
 
 Engine::Ptr Engine::Create(const Engine::Observer& observer,
                            const Logger& logger) {
@@ -53,6 +145,7 @@ Engine::Ptr Engine::Create(const Engine::Observer& observer,
 
 bool Engine::StartGame(const Options* options) {
   logger_.Log(Logger::Level::kInfo, __func__ + std::string{'\n'});
+  ponderer_.Cancel();
   side_that_wins_ = Side::kUnset;
   options_ = (options ? *options : Options{});
   if (!options_.data.empty()) {
@@ -64,6 +157,8 @@ bool Engine::StartGame(const Options* options) {
     board_.Reset();
     num_seq_moves_ = 0;
   }
+  jumper_ = Position::kNoJumper;
+  InvalidateBoards(kAllSquares);
   history_.clear();
   observer_.OnGameStarted(Config::kBoardSize);
 
@@ -88,15 +183,8 @@ bool Engine::StartGame(const Options* options) {
     return true;
   }
 
-  const auto& coords = GetCoords(side_to_move_);
-  auto can_move = std::any_of(coords.begin(), coords.end(),
-                              [this](const Coord& c){
-                                return CanMove(c.x(), c.y());
-                              });
-  auto can_take = std::any_of(coords.begin(), coords.end(),
-                              [this](const Coord& c){
-                                return CanTake(c.x(), c.y());
-                              });
+  auto can_move = CanMove(side_to_move_);
+  auto can_take = CanTake(side_to_move_);
   if (!can_move && !can_take) {
     observer_.OnGameUpdated(Side::kUnset, static_cast<Board::Data>(board_));
     OnGameEnded(rev_side);
@@ -122,13 +210,10 @@ bool Engine::StartGame(const Options* options) {
     if (options_.has_history) {
       history_.emplace_back(std::move(cmd));
     }
-    p_cmd->Execute();
+    Execute(*p_cmd);
   }
 
-  auto comp = GetComputerToMove();
-  if (comp) {
-    comp->Proceed();
-  }
+  RunComputers();
 
   return true;
 }
@@ -188,26 +273,34 @@ bool Engine::Revert() {
     return false;
   }
 
+  ponderer_.Cancel();
   auto& cmd = history_.back();
+  auto squares = GetCommandSquares(cmd->coord(), cmd->direction());
+  expected_squares_ = squares;
   cmd->Revert();
+  expected_squares_ = 0;
+  // A take, which follows a take of the same side, continued a multi-jump
+  // of its piece.
+  jumper_ = Position::kNoJumper;
+  if ((history_.size() > 1) && IsTake(*cmd)) {
+    const auto& prev_cmd = *history_[history_.size() - 2];
+    if (IsTake(prev_cmd) &&
+        (prev_cmd.side_to_move() == cmd->side_to_move())) {
+      jumper_ = BitBoard::ToSquare(cmd->coord().x(), cmd->coord().y());
+    }
+  }
   history_.pop_back();
+  InvalidateBoards(squares);
+  assert(IsMirrored(board_, GetBitBoardSnapshot(), GetMailbox()));
 
   return true;
 }
 
 bool Engine::CanMove(Side side) const {
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        Coord coord = piece_it.GetCoord();
-        if (CanMove(coord.x(), coord.y())) {
-          return true;
-        }
-      }
-    }
+  if (side != side_to_move_) {
+    return false;
   }
-  return false;
+  return GetBitBoard().CanMove(side);
 }
 
 bool Engine::CanMove(int x, int y) const {
@@ -218,44 +311,10 @@ bool Engine::CanMove(int x, int y) const {
 }
 
 bool Engine::CanMove(int x, int y, MoveDirection dir) const {
-  if (MoveDirection::kUnset == dir) {
-    return false;
-  }
-
-  try {
-    Coord coord{x, y};
-    const Piece* const& pbeg = board_(coord);
-    if (!pbeg) {
-      return false;
-    }
-
-    if (pbeg->side() != side_to_move_) {
-      return false;
-    }
-
-    if (pbeg->level() == Level::kMan) {
-      if (pbeg->side() == Side::kLight) {
-        if ((dir == MoveDirection::kBottomLeft) ||
-            (dir == MoveDirection::kBottomRight)) {
-          return false;
-        }
-      } else /*Side::kDark*/ {
-        if ((dir == MoveDirection::kTopLeft) ||
-            (dir == MoveDirection::kTopRight)) {
-          return false;
-        }
-      }
-    }
-
-    const Piece* const& pend = board_(coord.x() + Dx(dir),
-                                      coord.y() + Dy(dir));
-    if (pend) {
-      return false;
-    }
-  } catch (std::exception&) {
+  if (!Mailbox::IsInside(x, y)) {
     return false;
   }
-  return true;
+  return GetMailbox().CanMove(Mailbox::ToIndex(x, y), dir, side_to_move_);
 }
 
 bool Engine::Move(int x, int y, MoveDirection dir) {
@@ -271,34 +330,27 @@ bool Engine::Move(int x, int y, MoveDirection dir) {
     return false;
   }
 
+  auto side = side_to_move_;
   auto cmd = Command::Create<MoveCommand>(*this, *this, Coord{x, y}, dir);
   auto p_cmd = cmd.get();
   if (options_.has_history) {
     history_.emplace_back(std::move(cmd));
   }
-  p_cmd->Execute();
-
-  auto comp = GetComputerToMove();
-  if (comp) {
-    comp->Proceed();
+  Execute(*p_cmd);
+  if (side_to_move_ != side) {
+    UpdatePonder();
   }
 
+  RunComputers();
+
   return true;
 }
 
 bool Engine::CanTake(Side side) const {
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        Coord coord = piece_it.GetCoord();
-        if (CanTake(coord.x(), coord.y())) {
-          return true;
-        }
-      }
-    }
+  if (side != side_to_move_) {
+    return false;
   }
-  return false;
+  return GetBitBoard().CanTake(side);
 }
 
 bool Engine::CanTake(int x, int y) const {
@@ -309,51 +361,10 @@ bool Engine::CanTake(int x, int y) const {
 }
 
 bool Engine::CanTake(int x, int y, MoveDirection dir) const {
-  if (MoveDirection::kUnset == dir) {
+  if (!Mailbox::IsInside(x, y)) {
     return false;
   }
-
-  try {
-    Coord coord{x, y};
-    const Piece* const& pbeg = board_(coord);
-    if (!pbeg) {
-      return false;
-    }
-
-    if (pbeg->side() != side_to_move_) {
-      return false;
-    }
-
-    if (pbeg->level() == Level::kMan) {
-      if (pbeg->side() == Side::kLight) {
-        if ((dir == MoveDirection::kBottomLeft) ||
-            (dir == MoveDirection::kBottomRight)) {
-          return false;
-        }
-      } else /*Side::kDark*/ {
-        if ((dir == MoveDirection::kTopLeft) ||
-            (dir == MoveDirection::kTopRight)) {
-          return false;
-        }
-      }
-    }
-
-    const Piece* const& pmid = board_(coord.x() + Dx(dir),
-                                      coord.y() + Dy(dir));
-    if (!pmid || (pmid->side() == pbeg->side())) {
-      return false;
-    }
-
-    Coord take_pos{coord.x() + 2 * Dx(dir),
-                   coord.y() + 2 * Dy(dir)};
-    const Piece* const& pend = board_(take_pos);
-    if (pend) {
-      return false;
-    }
-  } catch (std::exception&) {
-    return false;
-  }
-  return true;
+  return GetMailbox().CanTake(Mailbox::ToIndex(x, y), dir, side_to_move_);
 }
 
 bool Engine::Take(int x, int y, MoveDirection dir) {
@@ -365,41 +376,28 @@ bool Engine::Take(int x, int y, MoveDirection dir) {
     return false;
   }
 
+  auto side = side_to_move_;
   auto cmd = Command::Create<TakeCommand>(*this, *this, Coord{x, y}, dir, true);
   auto p_cmd = cmd.get();
   if (options_.has_history) {
     history_.emplace_back(std::move(cmd));
   }
-  p_cmd->Execute();
-
-  auto comp = GetComputerToMove();
-  if (comp) {
-    comp->Proceed();
+  Execute(*p_cmd);
+  if (side_to_move_ != side) {
+    UpdatePonder();
   }
 
+  RunComputers();
+
   return true;
 }
 
 std::vector<HistoryItem> Engine::GetHistory(int size) {
   std::vector<HistoryItem> history_items;
-  auto absz = [](int sz) {
-    return (sz >= 0) ? sz : -sz;
-  };
-  size = (size < 0) ? absz(size) : (size == 0) ? history_.size() : size;
-  size = std::min(size, static_cast<int>(history_.size()));
+  size = ToHistorySize(size, history_.size());
   history_items.reserve(size + 1);
-  auto it = [this, &size] {
-    int iend = history_.size() - size;
-    auto it = history_.begin();
-    for (int i{}; i < iend; ++i, ++it) {}
-    return it;
-  }();
-  for (; it != history_.end(); ++it) {
-    history_items.emplace_back((*it)->coord().x(), (*it)->coord().y(),
-                               (*it)->direction(), (*it)->side_to_move(),
-                               (*it)->num_kings(), (*it)->num_men(),
-                               (*it)->num_seq_moves(),
-                               (*it)->num_promo_paths());
+  for (auto it = history_.end() - size; it != history_.end(); ++it) {
+    history_items.push_back(ToHistoryItem(**it));
   }
   const std::map<Side, int> num_kings{
     {Side::kLight,
@@ -422,6 +420,109 @@ std::vector<HistoryItem> Engine::GetHistory(int size) {
   return history_items;
 }
 
+int Engine::ExportHistory(int size, FlatHistoryItem* items,
+                          int capacity) const {
+  size = ToHistorySize(size, history_.size());
+  if (capacity < size + 1) {
+    std::ostringstream oss;
+    oss << "(" << capacity << " < " << size + 1 << ")";
+    throw std::invalid_argument{"Insufficient capacity - " + oss.str()};
+  }
+  for (auto it = history_.end() - size; it != history_.end(); ++it) {
+    *items++ = ToFlatHistoryItem(**it);
+  }
+  const auto& bitboard = GetBitBoard();
+  FlatHistoryItem item;
+  item.side_to_move = side_to_move_;
+  item.num_seq_moves = num_seq_moves_;
+  for (auto side : {Side::kLight, Side::kDark}) {
+    auto i = FlatHistoryItem::ToIndex(side);
+    item.num_kings[i] =
+        BitBoard::PopCount(bitboard.pieces(side, Level::kKing));
+    item.num_men[i] = BitBoard::PopCount(bitboard.pieces(side, Level::kMan));
+    item.num_promo_paths[i] = GetPromoPaths(side);
+  }
+  *items = item;
+  return size + 1;
+}
+
+HistoryItem Engine::GetHistoryItem(int ply) const {
+  if ((ply < 0) || (ply >= static_cast<int>(history_.size()))) {
+    std::ostringstream oss;
+    oss << "(" << ply << ")";
+    throw std::out_of_range{"Invalid history ply - " + oss.str()};
+  }
+  return ToHistoryItem(*history_[ply]);
+}
+
+std::uint64_t Engine::GetHash() const {
+  using Zobrist = BitBoard::Zobrist;
+  return GetBitBoard().hash() ^ Zobrist::GetSideKey(side_to_move_) ^
+         Zobrist::GetSeqMovesKey(num_seq_moves_) ^
+         ((jumper_ != Position::kNoJumper) ? Zobrist::GetJumperKey(jumper_) :
+                                             Zobrist::Key{});
+}
+
+Position Engine::GetPosition() const {
+  return Position{GetBitBoardSnapshot(), side_to_move_, num_seq_moves_,
+                  GameType::kAnalysis != options_.game_type, jumper_};
+}
+
+Search::Result Engine::Analyze(const Search::Limits& limits) const {
+  auto search_limits = limits;
+  if (!search_limits.tablebase) {
+    search_limits.tablebase = tablebase_.get();
+  }
+  auto ponder_limits = search_limits;
+  // StopAnalysis stops the search on top of any flag of the caller. A stop,
+  // which comes before the search, still applies to it; the search
+  // consumes it on return.
+  search_limits.owner_stop = &is_analysis_stopped_;
+  auto position = GetPosition();
+  Search::Result result;
+  if (ponderer_.IsHit(position)) {
+    result = ponderer_.Finish(search_limits);
+  } else {
+    ponderer_.Cancel();
+    Search search{transposition_table_};
+    result = search.Run(position, search_limits);
+  }
+  is_analysis_stopped_ = false;
+  Position reply;
+  if (is_ponder_enabled_ && Ponderer::Predict(position, result.pv, reply)) {
+    ponderer_.Start(reply, ponder_limits);
+  }
+  return result;
+}
+
+void Engine::SetPonder(bool is_enabled) {
+  is_ponder_enabled_ = is_enabled;
+  if (!is_enabled) {
+    ponderer_.Cancel();
+  }
+}
+
+void Engine::StopAnalysis() const { is_analysis_stopped_ = true; }
+
+void Engine::SetHashSize(std::size_t megabytes) {
+  // A ponder search must not probe the table, while it gets reallocated.
+  ponderer_.Cancel();
+  transposition_table_.Resize(megabytes);
+}
+
+void Engine::SetTablebase(const std::string& directory) {
+  // A ponder search may still probe the previous tablebase.
+  ponderer_.Cancel();
+  tablebase_ = directory.empty() ?
+      nullptr : std::make_unique<TablebaseProber>(directory);
+}
+
+bool Engine::Play(const MoveRecord& move) {
+  auto coord = BitBoard::ToCoord(move.square);
+  return move.is_take ? Take(coord.x(), coord.y(), move.direction) :
+                        Move(coord.x(), coord.y(), move.direction);
+}
+
 Engine::Engine(const Observer& observer, const Logger& logger)
     : observer_{const_cast<Engine::Observer&>(observer)},
       logger_{const_cast<Engine::Logger&>(logger)} {}
@@ -457,41 +558,15 @@ std::pair<bool, std::list<Command::Ptr>> Engine::Proceed() {
 }
 
 bool Engine::HasPieces(Side side) const {
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        return true;
-      }
-    }
-  }
-  return false;
+  return GetBitBoard().pieces(side) != 0;
 }
 
 int Engine::GetPiecesCount(Side side) const {
-  int count = 0;
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        ++count;
-      }
-    }
-  }
-  return count;
+  return BitBoard::PopCount(GetBitBoard().pieces(side));
 }
 
 int Engine::GetPiecesCount(Side side, Level level) const {
-  int count = 0;
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side) && (piece->level() == level)) {
-        ++count;
-      }
-    }
-  }
-  return count;
+  return BitBoard::PopCount(GetBitBoard().pieces(side, level));
 }
 
 std::list<Coord> Engine::GetCoords() const {
@@ -506,70 +581,43 @@ std::list<Coord> Engine::GetCoords() const {
 }
 
 std::list<Coord> Engine::GetCoords(Side side) const {
-  std::list<Coord> coords;
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        Coord coord = piece_it.GetCoord();
-        coords.push_back(coord);
-      }
-    }
-  }
-  return coords;
+  return ToCoords(GetBitBoard().pieces(side));
 }
 
 std::list<Coord> Engine::GetCoords(Side side, Level level) const {
-  std::list<Coord> count;
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side) && (piece->level() == level)) {
-        Coord coord = piece_it.GetCoord();
-        count.push_back(coord);
-      }
-    }
-  }
-  return count;
+  return ToCoords(GetBitBoard().pieces(side, level));
 }
 
 std::list<Command::Ptr> Engine::GetAutoCommands(const Coord& coord) const {
-  Client cli{side_to_move_};
-  Engine eng{cli, cli};
-  Options opts{GameType::kAnalysis, side_to_move_,
-               static_cast<Board::Data>(board_), num_seq_moves_, false};
-  eng.StartGame(&opts);
   std::list<Command::Ptr> commands;
-  for (auto& cmd : eng.GetMoves(coord)) {
-    cmd->Execute();
-    if (Reverse(cli.side_to_move()) == cli.side_that_wins()) {
-    } else if (eng.CanTake(eng.side_to_move_)) {
-    } else {
-      commands.emplace_back(
-        Command::Create<MoveCommand>(*this, *this, cmd->coord(),
-                                     cmd->direction()));
+  auto position = GetPosition();
+  auto square = BitBoard::ToSquare(coord.x(), coord.y());
+  for (auto dir : BitBoard::kDirections) {
+    if (!(position.board().GetMovers(side_to_move_, dir) &
+          BitBoard::ToMask(square))) {
+      continue;
     }
-    cli.Reset();
-    cmd->Revert();
+    MoveRecord move{static_cast<std::uint8_t>(square), dir, false};
+    auto undo = position.DoMove(move);
+    if (position.IsDrawn() ||
+        !position.board().CanTake(position.side_to_move())) {
+      commands.push_back(CreateCommand(move));
+    }
+    position.UndoMove(undo);
   }
   return commands;
 }
 
 std::list<Command::Ptr> Engine::GetMoves(Side side) const {
-  std::list<Command::Ptr> moves;
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        Coord coord = piece_it.GetCoord();
-        auto moves_by_pos = GetMoves(coord);
-        for (auto& move : moves_by_pos) {
-          moves.push_back(std::move(move));
-        }
-      }
-    }
+  BitBoard::MoveList moves;
+  GetMoves(side, moves);
+  return CreateCommands(moves);
+}
+
+void Engine::GetMoves(Side side, BitBoard::MoveList& moves) const {
+  if (side == side_to_move_) {
+    GetBitBoard().GenerateMoves(side, moves);
   }
-  return moves;
 }
 
 std::list<Command::Ptr> Engine::GetMoves(const Coord& pos) const {
@@ -598,62 +646,26 @@ std::list<Command::Ptr> Engine::GetMoves(const Coord& pos) const {
 }
 
 std::list<Command::Ptr> Engine::GetTakes() const {
-  std::list<Command::Ptr> takes;
-  for (int x{1}; x <= Config::kBoardSize; ++x) {
-    for (int y{1}; y <= Config::kBoardSize; ++y) {
-      auto takes_by_pos = GetTakes(Coord{x, y});
-      for (auto& take : takes_by_pos) {
-        takes.push_back(std::move(take));
-      }
-    }
-  }
-  return takes;
+  return GetTakes(side_to_move_);
 }
 
 std::list<Command::Ptr> Engine::GetTakes(Side side) const {
-  std::list<Command::Ptr> takes;
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        Coord coord = piece_it.GetCoord();
-        auto takes_by_pos = GetTakes(coord);
-        for (auto& take : takes_by_pos) {
-          takes.push_back(std::move(take));
-        }
-      }
-    }
+  BitBoard::MoveList takes;
+  GetTakes(side, takes);
+  return CreateCommands(takes);
+}
+
+void Engine::GetTakes(Side side, BitBoard::MoveList& takes) const {
+  if (side == side_to_move_) {
+    GetBitBoard().GenerateTakes(side, takes);
   }
-  return takes;
 }
 
 int Engine::GetTakesCount(Side side) const {
-  int count{};
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side)) {
-        Coord coord = piece_it.GetCoord();
-        if (CanTake(coord.x(), coord.y(),
-                    MoveDirection::kTopLeft)) {
-          ++count;
-        }
-        if (CanTake(coord.x(), coord.y(),
-                    MoveDirection::kTopRight)) {
-          ++count;
-        }
-        if (CanTake(coord.x(), coord.y(),
-                    MoveDirection::kBottomLeft)) {
-          ++count;
-        }
-        if (CanTake(coord.x(), coord.y(),
-                    MoveDirection::kBottomRight)) {
-          ++count;
-        }
-      }
-    }
+  if (side != side_to_move_) {
+    return 0;
   }
-  return count;
+  return GetBitBoard().GetTakesCount(side);
 }
 
 std::list<Command::Ptr> Engine::GetTakes(const Coord& pos) const {
@@ -681,68 +693,40 @@ std::list<Command::Ptr> Engine::GetTakes(const Coord& pos) const {
   return takes;
 }
 
-int Engine::GetPromoPaths(Side side) {
-  int count{};
-  Side last_side_to_move = side_to_move_;
-  if (side_to_move_ != side) {
-    side_to_move_ = side;
-  }
-  for (const auto& row : board_) {
-    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
-      auto piece = *piece_it;
-      if (piece && (piece->side() == side) && (piece->level() == Level::kMan)) {
-        Coord coord = piece_it.GetCoord();
-        if (FindPromoPath(coord, MoveDirection::kTopLeft)) {
-          ++count;
-        }
-        if (FindPromoPath(coord, MoveDirection::kTopRight)) {
-          ++count;
-        }
-        if (FindPromoPath(coord, MoveDirection::kBottomLeft)) {
-          ++count;
-        }
-        if (FindPromoPath(coord, MoveDirection::kBottomRight)) {
-          ++count;
-        }
-      }
-    }
+Command::Ptr Engine::CreateCommand(const MoveRecord& move) const {
+  auto pos = BitBoard::ToCoord(move.square);
+  if (move.is_take) {
+    return Command::Create<TakeCommand>(*this, *this, pos, move.direction,
+                                        true);
   }
-  if (side_to_move_ != last_side_to_move) {
-    side_to_move_ = last_side_to_move;
-  }
-  return count;
+  return Command::Create<MoveCommand>(*this, *this, pos, move.direction);
 }
 
-bool Engine::FindPromoPath(const Coord& prev, MoveDirection dir) {
-  if (!CanMove(prev.x(), prev.y(), dir)) {
-    return false;
-  }
-  Coord next{prev.x() + Dx(dir),
-             prev.y() + Dy(dir)};
-  if ((next.x() == 1) || (next.x() == Config::kBoardSize)) {
-    return true;
-  }
-  auto& pprev = board_(prev.x(), prev.y());
-  auto& pnext = board_(next.x(), next.y());
-  std::swap(pprev, pnext);
-
-  side_to_move_ = Reverse(side_to_move_);
-  if (CanTake(side_to_move_)) {
-    std::swap(pprev, pnext);
-    side_to_move_ = Reverse(side_to_move_);
-    return false;
+std::list<Command::Ptr> Engine::CreateCommands(
+    const BitBoard::MoveList& moves) const {
+  std::list<Command::Ptr> commands;
+  for (const auto& move : moves) {
+    commands.push_back(CreateCommand(move));
   }
+  return commands;
+}
 
-  side_to_move_ = Reverse(side_to_move_);
-  bool found = false;
-  for (auto& m : GetMoves(next)) {
-    if (FindPromoPath(m->coord(), m->direction())) {
-      found = true;
-      break;
+int Engine::GetPromoPaths(Side side) const {
+  // Works on a snapshot, so that concurrent readers never observe or
+  // disturb the shared board state.
+  auto bitboard = GetBitBoardSnapshot();
+  {
+    std::lock_guard<std::mutex> lock{promo_paths_mutex_};
+    auto it = promo_paths_cache_.find(side);
+    if ((it != promo_paths_cache_.end()) &&
+        (it->second.first == bitboard.hash())) {
+      return it->second.second;
     }
   }
-  std::swap(pprev, pnext);
-  return found;
+  auto count = bitboard.CountPromoPaths(side);
+  std::lock_guard<std::mutex> lock{promo_paths_mutex_};
+  promo_paths_cache_[side] = {bitboard.hash(), count};
+  return count;
 }
 
 void Engine::BeforeMove(Side side_to_move, int num_seq_moves) {
@@ -750,10 +734,13 @@ void Engine::BeforeMove(Side side_to_move, int num_seq_moves) {
     side_to_move_ = side_to_move;
     num_seq_moves_ = num_seq_moves;
   }
+  BeginChange();
   observer_.OnGameUpdated(side_to_move_, static_cast<Board::Data>(board_));
 }
 
 std::list<Command::Ptr> Engine::AfterMove() {
+  InvalidateBoards(changed_squares_);
+  jumper_ = Position::kNoJumper;
   if (++num_seq_moves_ == kMaxNumSeqMoves) {
     observer_.OnGameUpdated(Side::kUnset, static_cast<Board::Data>(board_));
     OnGameEnded(Side::kNeutral);
@@ -777,10 +764,13 @@ void Engine::BeforeTake(Side side_to_move, int num_seq_moves) {
     side_to_move_ = side_to_move;
     num_seq_moves_ = num_seq_moves;
   }
+  BeginChange();
   observer_.OnGameUpdated(side_to_move_, static_cast<Board::Data>(board_));
 }
 
 std::list<Command::Ptr> Engine::AfterTake() {
+  InvalidateBoards(changed_squares_);
+  jumper_ = Position::kNoJumper;
   side_to_move_ = Reverse(side_to_move_);
 
   auto to_proceed = Proceed();
@@ -793,9 +783,13 @@ std::list<Command::Ptr> Engine::AfterTake() {
 }
 
 std::list<Command::Ptr> Engine::AfterTake(const Coord& coord) {
+  InvalidateBoards(changed_squares_);
   observer_.OnGameUpdated(side_to_move_, static_cast<Board::Data>(board_));
   num_seq_moves_ = 0;
-  return GetTakes(coord);
+  auto takes = GetTakes(coord);
+  jumper_ = takes.empty() ? Position::kNoJumper :
+                            BitBoard::ToSquare(coord.x(), coord.y());
+  return takes;
 }
 
 void Engine::SetupComputers() {
@@ -805,6 +799,7 @@ void Engine::SetupComputers() {
     throw std::invalid_argument{"Invalid GameType - " + oss.str()};
   }
 
+  computer_limits_ = ToComputerLimits(options_);
   switch (options_.game_type) {
     case GameType::kHumanComputer:
       computer1_ = Computer::Create(Side::kDark, *this);
@@ -825,6 +820,153 @@ void Engine::SetupComputers() {
   }
 }
 
+const BitBoard& Engine::GetBitBoard() const {
+  SyncBoards();
+  return bitboard_;
+}
+
+BitBoard Engine::GetBitBoardSnapshot() const {
+  SyncBoards();
+  // A resync patches bitboard_ under the lock, so the copy is taken under
+  // it as well.
+  std::lock_guard<std::mutex> lock{boards_mutex_};
+  return bitboard_;
+}
+
+const Mailbox& Engine::GetMailbox() const {
+  SyncBoards();
+  return mailbox_;
+}
+
+void Engine::SyncBoards() const {
+  if (boards_synced_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock{boards_mutex_};
+  if (boards_synced_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (stale_squares_ == kAllSquares) {
+    bitboard_.Reset(board_);
+    mailbox_.Reset(board_);
+  } else {
+    while (stale_squares_) {
+      auto square = BitBoard::PopLowest(stale_squares_);
+      auto coord = BitBoard::ToCoord(square);
+      const Piece* piece = board_(coord);
+      bitboard_.Remove(square);
+      if (piece) {
+        bitboard_.Put(square, piece->side(), piece->level());
+      }
+      mailbox_.Set(Mailbox::ToIndex(coord.x(), coord.y()), piece);
+    }
+  }
+  stale_squares_ = 0;
+  boards_synced_.store(true, std::memory_order_release);
+}
+
+void Engine::InvalidateBoards(BitBoard::Mask squares) {
+  std::lock_guard<std::mutex> lock{boards_mutex_};
+  stale_squares_ |= squares;
+  boards_synced_.store(false, std::memory_order_release);
+}
+
+void Engine::Execute(Command& cmd) {
+  expected_squares_ = GetCommandSquares(cmd.coord(), cmd.direction());
+  cmd.Execute();
+  // A command, which never called a Before hook, broke the contract of
+  // BeginChange; the backends then need a full reset.
+  assert(!expected_squares_);
+  if (expected_squares_) {
+    expected_squares_ = 0;
+    InvalidateBoards(kAllSquares);
+  }
+  assert(IsMirrored(board_, GetBitBoardSnapshot(), GetMailbox()));
+}
+
+void Engine::BeginChange() {
+  // Commands report their changes of board_ through the Before/After
+  // hooks, which MoveCommand/TakeCommand (src/) call under this contract:
+  // - a command calls BeforeMove/BeforeTake in Execute before it changes
+  //   board_, and in Revert at any point;
+  // - it only changes the squares of GetCommandSquares;
+  // - a command, which it runs in turn, e.g. a single auto-command,
+  //   starts after that first hook.
+  // Thus the first hook within Execute or Revert stands for the command
+  // itself; a further one for a command, whose squares are not known.
+  // Execute and Revert assert, that the backends mirror board_ after
+  // each command.
+  changed_squares_ = expected_squares_ ? expected_squares_ : kAllSquares;
+  expected_squares_ = 0;
+  InvalidateBoards(changed_squares_);
+}
+
+bool Engine::StepComputer() {
+  // A computer, which plays its turn, re-enters here through Move/Take;
+  // the loop of the caller continues with the next turn.
+  if (is_running_computers_) {
+    return false;
+  }
+  if (!GetComputerToMove()) {
+    return false;
+  }
+  auto hash = GetHash();
+  is_running_computers_ = true;
+  try {
+    PlaySearchedTurn();
+  } catch (...) {
+    is_running_computers_ = false;
+    throw;
+  }
+  is_running_computers_ = false;
+  return GetHash() != hash;
+}
+
+bool Engine::PlaySearchedTurn() {
+  auto side = side_to_move_;
+  // Plays the principal variation of the search within computer_limits_;
+  // one, which ends within a multi-jump, gets searched again from there.
+  while (side_to_move_ == side) {
+    auto result = Analyze(computer_limits_);
+    if (result.pv.empty()) {
+      // A search, which stops before its first iteration, still returns a
+      // legal move, if there is any.
+      if (!GetPosition().HasMoves()) {
+        return false;
+      }
+      result.pv.push_back(result.best_move);
+    }
+    for (auto it = result.pv.begin();
+         (it != result.pv.end()) && (side_to_move_ == side); ++it) {
+      if (!Play(*it)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void Engine::SetAutoPlay(bool is_auto_play) { is_auto_play_ = is_auto_play; }
+
+void Engine::RunComputers() {
+  if (!is_auto_play_) {
+    return;
+  }
+  while (StepComputer()) {
+  }
+}
+
+void Engine::UpdatePonder() {
+  // Called once a turn has passed, i.e. the reply of the opponent is
+  // complete, when it is the turn of the pondering side again.
+  if (side_to_move_ == Side::kUnset) {
+    ponderer_.Cancel();
+  } else if ((side_to_move_ == ponderer_.side_to_move()) &&
+             !ponderer_.IsHit(GetPosition())) {
+    ponderer_.Cancel();
+  }
+}
+
 Computer* Engine::GetComputerToMove() const {
   for (auto& c : {computer1_.get(), computer2_.get()}) {
     if (c && (c->side() == side_to_move_)) {
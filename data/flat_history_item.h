@@ -0,0 +1,35 @@
+#ifndef SRC_FLAT_HISTORY_ITEM_H_
+#define SRC_FLAT_HISTORY_ITEM_H_
+
+#include <array>
+#include <type_traits>
+
+#include "src/common.h"
+
+namespace checkers_style_game {
+
+// Trivially copyable counterpart of HistoryItem, which keeps the per-side
+// counters in fixed arrays indexed by ToIndex(side) instead of std::map.
+struct FlatHistoryItem final {
+  static constexpr int kNumSides = 2;
+
+  static constexpr int ToIndex(Side side) {
+    return (side == Side::kDark) ? 1 : 0;
+  }
+
+  int x{};
+  int y{};
+  MoveDirection direction{MoveDirection::kUnset};
+  Side side_to_move{Side::kUnset};
+  std::array<int, kNumSides> num_kings{};
+  std::array<int, kNumSides> num_men{};
+  int num_seq_moves{};
+  std::array<int, kNumSides> num_promo_paths{};
+};
+
+static_assert(std::is_trivially_copyable_v<FlatHistoryItem>,
+              "FlatHistoryItem must be trivially copyable");
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_FLAT_HISTORY_ITEM_H_
@@ -0,0 +1,72 @@
+#ifndef SRC_GEOMETRY_H_
+#define SRC_GEOMETRY_H_
+
+#include "src/common.h"
+
+namespace checkers_style_game {
+
+// Compile-time board geometry for a kSize x kSize board. The direction
+// offsets follow Dx/Dy, i.e. top means a lower x and left means a lower y.
+template <int kSize>
+struct Geometry final {
+  static_assert((kSize >= 4) && (kSize % 2 == 0), "Unsupported board size");
+
+  static constexpr int kNumSquares = kSize * kSize;
+  static constexpr int kNumDirections = 4;
+
+  static constexpr MoveDirection kDirections[kNumDirections] = {
+    MoveDirection::kTopLeft, MoveDirection::kTopRight,
+    MoveDirection::kBottomLeft, MoveDirection::kBottomRight
+  };
+  static constexpr int kDx[kNumDirections] = {-1, -1, 1, 1};
+  static constexpr int kDy[kNumDirections] = {-1, 1, -1, 1};
+
+  static constexpr int ToDirectionIndex(MoveDirection dir) {
+    switch (dir) {
+      case MoveDirection::kTopLeft:
+        return 0;
+      case MoveDirection::kTopRight:
+        return 1;
+      case MoveDirection::kBottomLeft:
+        return 2;
+      default /*MoveDirection::kBottomRight*/:
+        return 3;
+    }
+  }
+
+  static constexpr MoveDirection Opposite(MoveDirection dir) {
+    return kDirections[kNumDirections - 1 - ToDirectionIndex(dir)];
+  }
+
+  // Whether a man of side may head in dir.
+  static constexpr bool IsForward(Side side, MoveDirection dir) {
+    return (side == Side::kLight) ? (kDx[ToDirectionIndex(dir)] < 0) :
+                                    (kDx[ToDirectionIndex(dir)] > 0);
+  }
+
+  static constexpr bool IsInside(int x, int y) {
+    return (x >= 1) && (x <= kSize) && (y >= 1) && (y <= kSize);
+  }
+
+  // Whether row x is the last row for a man, i.e. its promotion row.
+  static constexpr bool IsEdgeRow(int x) { return (x == 1) || (x == kSize); }
+};
+
+// Engine steps through Dx/Dy, so the offsets have to agree with them.
+template <int kSize>
+constexpr bool HasCommonOffsets() {
+  using Geometry = checkers_style_game::Geometry<kSize>;
+  for (int i{}; i < Geometry::kNumDirections; ++i) {
+    auto dir = Geometry::kDirections[i];
+    if ((Geometry::kDx[i] != Dx(dir)) || (Geometry::kDy[i] != Dy(dir))) {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(HasCommonOffsets<8>() && HasCommonOffsets<10>(),
+              "Direction offsets differ from Dx/Dy");
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_GEOMETRY_H_
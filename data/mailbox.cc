@@ -0,0 +1,8 @@
+#include "src/mailbox.h"
+
+namespace checkers_style_game {
+
+template class BasicMailbox<8>;
+template class BasicMailbox<10>;
+
+}  // namespace checkers_style_game
@@ -0,0 +1,179 @@
+#ifndef SRC_MAILBOX_H_
+#define SRC_MAILBOX_H_
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "src/board.h"
+#include "src/common.h"
+#include "src/config.h"
+#include "src/coord.h"
+#include "src/geometry.h"
+
+namespace checkers_style_game {
+
+// Board backend, which pads the board with a border of sentinel cells, so
+// that probing beyond an edge never throws. Neighbour and jump-landing
+// indices are precomputed per cell and direction at compile time; landings
+// beyond the border resolve to a sentinel cell as well.
+template <int kSize>
+class BasicMailbox final {
+ public:
+  using Geometry = checkers_style_game::Geometry<kSize>;
+
+  enum class Cell : std::uint8_t {
+    kEmpty,
+    kLightMan,
+    kLightKing,
+    kDarkMan,
+    kDarkKing,
+    kOffBoard
+  };
+
+  static constexpr int kWidth = kSize + 2;
+  static constexpr int kNumCells = kWidth * kWidth;
+
+  static constexpr bool IsInside(int x, int y) {
+    return Geometry::IsInside(x, y);
+  }
+  static constexpr int ToIndex(int x, int y) { return x * kWidth + y; }
+  static constexpr int GetNeighbour(int index, MoveDirection dir) {
+    return kNeighbours[index][Geometry::ToDirectionIndex(dir)];
+  }
+  static constexpr int GetLanding(int index, MoveDirection dir) {
+    return kLandings[index][Geometry::ToDirectionIndex(dir)];
+  }
+
+  BasicMailbox() { cells_.fill(Cell::kOffBoard); }
+
+  // Board always has Config::kBoardSize rows, so only the backend of that
+  // size may mirror it. Being a template keeps the other sizes compiling.
+  template <int kBoardSize = Config::kBoardSize>
+  void Reset(const Board& board);
+  void Relocate(int from, int to);
+  // Mirrors piece, which may be null, on the cell at index.
+  void Set(int index, const Piece* piece) { cells_[index] = ToCell(piece); }
+
+  Cell operator[](int index) const { return cells_[index]; }
+
+  // Mirrors Engine::CanMove/CanTake for the piece at index.
+  bool CanMove(int index, MoveDirection dir, Side side_to_move) const {
+    if (GetHeading(index, dir, side_to_move) == Cell::kEmpty) {
+      return false;
+    }
+    return cells_[GetNeighbour(index, dir)] == Cell::kEmpty;
+  }
+  bool CanTake(int index, MoveDirection dir, Side side_to_move) const {
+    auto cell = GetHeading(index, dir, side_to_move);
+    if (cell == Cell::kEmpty) {
+      return false;
+    }
+    auto side = GetSide(cells_[GetNeighbour(index, dir)]);
+    if ((side == Side::kUnset) || (side == GetSide(cell))) {
+      return false;
+    }
+    return cells_[GetLanding(index, dir)] == Cell::kEmpty;
+  }
+
+ private:
+  using Table = std::array<std::array<std::int16_t, Geometry::kNumDirections>,
+                           kNumCells>;
+
+  static constexpr int kSentinel = 0;
+
+  static constexpr Table MakeTable(int distance) {
+    Table table{};
+    for (int x{}; x < kWidth; ++x) {
+      for (int y{}; y < kWidth; ++y) {
+        for (int i{}; i < Geometry::kNumDirections; ++i) {
+          auto tx = x + distance * Geometry::kDx[i];
+          auto ty = y + distance * Geometry::kDy[i];
+          table[ToIndex(x, y)][i] =
+              ((tx >= 0) && (tx < kWidth) && (ty >= 0) && (ty < kWidth)) ?
+                  ToIndex(tx, ty) : kSentinel;
+        }
+      }
+    }
+    return table;
+  }
+
+  static constexpr Table kNeighbours = MakeTable(1);
+  static constexpr Table kLandings = MakeTable(2);
+
+  static Cell ToCell(const Piece* piece) {
+    if (!piece) {
+      return Cell::kEmpty;
+    }
+    auto is_king = (piece->level() == Level::kKing);
+    return (piece->side() == Side::kLight) ?
+               (is_king ? Cell::kLightKing : Cell::kLightMan) :
+               (is_king ? Cell::kDarkKing : Cell::kDarkMan);
+  }
+
+  static constexpr Side GetSide(Cell cell) {
+    switch (cell) {
+      case Cell::kLightMan:
+      case Cell::kLightKing:
+        return Side::kLight;
+      case Cell::kDarkMan:
+      case Cell::kDarkKing:
+        return Side::kDark;
+      default:
+        return Side::kUnset;
+    }
+  }
+
+  // Returns the cell of the piece at index, if it may head in dir.
+  Cell GetHeading(int index, MoveDirection dir, Side side_to_move) const {
+    if (MoveDirection::kUnset == dir) {
+      return Cell::kEmpty;
+    }
+    auto cell = cells_[index];
+    if (GetSide(cell) != side_to_move) {
+      return Cell::kEmpty;
+    }
+    if (((cell == Cell::kLightMan) || (cell == Cell::kDarkMan)) &&
+        !Geometry::IsForward(GetSide(cell), dir)) {
+      return Cell::kEmpty;
+    }
+    return cell;
+  }
+
+  std::array<Cell, kNumCells> cells_;
+};
+
+template <int kSize>
+template <int kBoardSize>
+void BasicMailbox<kSize>::Reset(const Board& board) {
+  static_assert(kBoardSize == kSize, "Board does not match the board size");
+  cells_.fill(Cell::kOffBoard);
+  for (int x{1}; x <= kSize; ++x) {
+    for (int y{1}; y <= kSize; ++y) {
+      cells_[ToIndex(x, y)] = Cell::kEmpty;
+    }
+  }
+  for (const auto& row : board) {
+    for (auto piece_it = row.begin(); piece_it != row.end(); ++piece_it) {
+      auto piece = *piece_it;
+      if (piece) {
+        Coord coord = piece_it.GetCoord();
+        Set(ToIndex(coord.x(), coord.y()), piece);
+      }
+    }
+  }
+}
+
+template <int kSize>
+void BasicMailbox<kSize>::Relocate(int from, int to) {
+  std::swap(cells_[from], cells_[to]);
+}
+
+extern template class BasicMailbox<8>;
+extern template class BasicMailbox<10>;
+
+using Mailbox = BasicMailbox<Config::kBoardSize>;
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_MAILBOX_H_
@@ -0,0 +1,56 @@
+#ifndef SRC_MOVE_LIST_H_
+#define SRC_MOVE_LIST_H_
+
+#include <array>
+#include <cstdint>
+
+#include "src/common.h"
+#include "src/geometry.h"
+
+namespace checkers_style_game {
+
+// Compact move record: the from-square in BitBoard numbering, the direction
+// and whether the move jumps over an opponent's piece.
+struct MoveRecord final {
+  std::uint8_t square{};
+  MoveDirection direction{MoveDirection::kUnset};
+  bool is_take{};
+
+  bool operator==(const MoveRecord& other) const {
+    return (square == other.square) && (direction == other.direction) &&
+           (is_take == other.is_take);
+  }
+  bool operator!=(const MoveRecord& other) const { return !(*this == other); }
+};
+
+// Fixed-capacity, allocation-free list of moves, which is meant to live on
+// the stack of the generating function. The capacity covers four directions
+// for every piece that fits on a kSize x kSize board.
+template <int kSize>
+class BasicMoveList final {
+ public:
+  static constexpr int kCapacity = 2 * Geometry<kSize>::kNumSquares;
+
+  void push_back(const MoveRecord& move) { moves_[size_++] = move; }
+  void pop_back() { --size_; }
+  void clear() { size_ = 0; }
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  MoveRecord& operator[](int i) { return moves_[i]; }
+  const MoveRecord& operator[](int i) const { return moves_[i]; }
+
+  MoveRecord* begin() { return moves_.data(); }
+  MoveRecord* end() { return moves_.data() + size_; }
+  const MoveRecord* begin() const { return moves_.data(); }
+  const MoveRecord* end() const { return moves_.data() + size_; }
+
+ private:
+  std::array<MoveRecord, kCapacity> moves_;
+  int size_{};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_MOVE_LIST_H_
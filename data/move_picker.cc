@@ -0,0 +1,109 @@
+#include "src/move_picker.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "src/common.h"
+#include "src/move_list.h"
+#include "src/position.h"
+
+namespace checkers_style_game {
+
+void MovePicker::Heuristics::Clear() {
+  killers_ = {};
+  history_ = {};
+}
+
+void MovePicker::Heuristics::Update(Side side, const MoveRecord& move,
+                                    int ply, int depth) {
+  auto& killers = killers_[ply];
+  if (killers[0] != move) {
+    killers[1] = killers[0];
+    killers[0] = move;
+  }
+  auto& score = history_[ToIndex(side)][move.square][ToIndex(move.direction)];
+  score += depth * depth;
+  if (score >= kMaxHistory) {
+    // Halves all scores of side, so that recent cutoffs weigh more.
+    for (auto& square : history_[ToIndex(side)]) {
+      for (auto& value : square) {
+        value /= 2;
+      }
+    }
+  }
+}
+
+bool MovePicker::Next(MoveRecord& move) {
+  switch (stage_) {
+    case Stage::kHashMove:
+      stage_ = Stage::kGenerate;
+      if (position_.IsLegal(hash_move_)) {
+        move = hash_move_;
+        return true;
+      }
+      [[fallthrough]];
+    case Stage::kGenerate:
+      Generate();
+      stage_ = Stage::kPick;
+      [[fallthrough]];
+    default /*Stage::kPick*/: {
+      if (next_ == moves_.size()) {
+        return false;
+      }
+      auto best = next_;
+      for (int i{next_ + 1}; i < moves_.size(); ++i) {
+        if (scores_[i] > scores_[best]) {
+          best = i;
+        }
+      }
+      std::swap(moves_[best], moves_[next_]);
+      std::swap(scores_[best], scores_[next_]);
+      move = moves_[next_++];
+      return true;
+    }
+  }
+}
+
+int MovePicker::GetChainLength(Position& position, const MoveRecord& move) {
+  auto undo = position.DoMove(move);
+  int length{};
+  if (position.jumper() != Position::kNoJumper) {
+    Position::MoveList moves;
+    position.GenerateMoves(moves);
+    for (const auto& next : moves) {
+      length = std::max(length, GetChainLength(position, next));
+    }
+  }
+  position.UndoMove(undo);
+  return length + 1;
+}
+
+void MovePicker::Generate() {
+  position_.GenerateMoves(moves_);
+  auto side = position_.side_to_move();
+  const auto& killers = heuristics_.GetKillers(ply_);
+  auto scratch = position_;
+  int size{};
+  for (const auto& move : moves_) {
+    if (move == hash_move_) {
+      continue;
+    }
+    int score{};
+    if (move.is_take) {
+      score = kTakeScore * GetChainLength(scratch, move);
+    } else if (move == killers[0]) {
+      score = kKillerScore;
+    } else if (move == killers[1]) {
+      score = kKillerScore - 1;
+    } else {
+      score = heuristics_.GetHistory(side, move);
+    }
+    scores_[size] = score;
+    moves_[size++] = move;
+  }
+  while (moves_.size() > size) {
+    moves_.pop_back();
+  }
+}
+
+}  // namespace checkers_style_game
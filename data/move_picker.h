@@ -0,0 +1,81 @@
+#ifndef SRC_MOVE_PICKER_H_
+#define SRC_MOVE_PICKER_H_
+
+#include <array>
+
+#include "src/common.h"
+#include "src/move_list.h"
+#include "src/position.h"
+
+namespace checkers_style_game {
+
+// Hands out the moves of a search node in stages: the hash move, which is
+// validated without generating anything, then the rest by score. Takes are
+// scored by the length of the longest jump chain they start, quiet moves
+// by whether they are killers of the ply and then by their history score.
+// Takes and quiet moves never mix, as takes are mandatory.
+class MovePicker final {
+ public:
+  static constexpr int kMaxPly = 128;
+  static constexpr int kNumKillers = 2;
+
+  // Killer moves and history scores, which are kept per search thread.
+  class Heuristics final {
+   public:
+    void Clear();
+
+    const std::array<MoveRecord, kNumKillers>& GetKillers(int ply) const {
+      return killers_[ply];
+    }
+    int GetHistory(Side side, const MoveRecord& move) const {
+      return history_[ToIndex(side)][move.square][ToIndex(move.direction)];
+    }
+
+    // Rewards a quiet move, which caused a beta cutoff at ply.
+    void Update(Side side, const MoveRecord& move, int ply, int depth);
+
+   private:
+    static constexpr int kMaxHistory = 1 << 20;
+
+    static int ToIndex(Side side) { return (side == Side::kDark) ? 1 : 0; }
+    static int ToIndex(MoveDirection dir) {
+      return Position::Geometry::ToDirectionIndex(dir);
+    }
+
+    std::array<std::array<MoveRecord, kNumKillers>, kMaxPly> killers_{};
+    std::array<std::array<std::array<int, Position::Geometry::kNumDirections>,
+                          Position::BitBoard::kNumSquares>, 2> history_{};
+  };
+
+  MovePicker(const Position& position, const MoveRecord& hash_move,
+             const Heuristics& heuristics, int ply)
+      : position_{position}, hash_move_{hash_move},
+        heuristics_{heuristics}, ply_{ply} {}
+
+  // Returns false, when no moves are left.
+  bool Next(MoveRecord& move);
+
+ private:
+  enum class Stage { kHashMove, kGenerate, kPick };
+
+  static constexpr int kKillerScore = 1 << 30;
+  static constexpr int kTakeScore = 1 << 24;
+
+  // Number of takes in the longest chain, which starts with move.
+  static int GetChainLength(Position& position, const MoveRecord& move);
+
+  void Generate();
+
+  const Position& position_;
+  const MoveRecord hash_move_;
+  const Heuristics& heuristics_;
+  const int ply_;
+  Stage stage_{Stage::kHashMove};
+  Position::MoveList moves_;
+  std::array<int, Position::MoveList::kCapacity> scores_;
+  int next_{};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_MOVE_PICKER_H_
@@ -0,0 +1,251 @@
+#include "src/perft.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "src/bitboard.h"
+#include "src/board.h"
+#include "src/common.h"
+#include "src/move_list.h"
+#include "src/options.h"
+#include "src/position.h"
+#include "src/thread_pool.h"
+
+namespace checkers_style_game {
+
+namespace {
+
+// Subtrees with at most this many plies left are counted by a single task.
+constexpr int kMaxTaskDepth = 6;
+
+// Only subtrees of at least this depth are worth a hash probe.
+constexpr int kMinHashDepth = 2;
+
+int GetNextDepth(const Position& position, int depth) {
+  // A pending continuation belongs to the same ply.
+  return (position.jumper() != Position::kNoJumper) ? depth : depth - 1;
+}
+
+}  // namespace
+
+// Lock-free table, where every entry keeps the key XOR-ed with the data next
+// to the data itself. A torn write by a concurrent store then fails the key
+// check on probe instead of returning a wrong count.
+class Perft::HashTable final {
+ public:
+  explicit HashTable(std::size_t megabytes) {
+    std::size_t size{1};
+    while (2 * size * sizeof(Entry) <= megabytes * 1024 * 1024) {
+      size *= 2;
+    }
+    entries_ = std::make_unique<Entry[]>(size);
+    mask_ = size - 1;
+  }
+
+  bool Probe(std::uint64_t key, int depth, std::uint64_t& num_leaves) const {
+    const auto& entry = entries_[key & mask_];
+    auto data = entry.data.load(std::memory_order_relaxed);
+    auto check = entry.check.load(std::memory_order_relaxed);
+    if (((check ^ data) != key) ||
+        (static_cast<int>(data & kDepthMask) != depth)) {
+      return false;
+    }
+    num_leaves = data >> kDepthBits;
+    return true;
+  }
+
+  void Store(std::uint64_t key, int depth, std::uint64_t num_leaves) {
+    auto& entry = entries_[key & mask_];
+    auto data = (num_leaves << kDepthBits) | static_cast<std::uint64_t>(depth);
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+  }
+
+  // Perft counts depend on the exact number of sequential moves, which the
+  // position hash only keeps in buckets.
+  static std::uint64_t ToKey(const Position& position) {
+    std::uint64_t z = position.hash() +
+        0x9E3779B97F4A7C15ull * (position.num_seq_moves() + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+ private:
+  static constexpr int kDepthBits = 8;
+  static constexpr std::uint64_t kDepthMask = (1u << kDepthBits) - 1;
+
+  struct Entry final {
+    std::atomic<std::uint64_t> check{};
+    std::atomic<std::uint64_t> data{};
+  };
+
+  std::unique_ptr<Entry[]> entries_;
+  std::size_t mask_{};
+};
+
+Position Perft::ToPosition(const Options& options) {
+  Board board;
+  BitBoard bitboard;
+  auto has_lone_piece_rule = GameType::kAnalysis != options.game_type;
+  if (!options.data.empty()) {
+    board.Reset(options.data);
+    bitboard.Reset(board);
+    return Position{bitboard, options.side_to_move, options.num_seq_moves,
+                    has_lone_piece_rule};
+  }
+  board.Reset();
+  bitboard.Reset(board);
+  return Position{bitboard, Side::kLight, 0, has_lone_piece_rule};
+}
+
+std::uint64_t Perft::Count(Position& position, int depth,
+                           std::uint64_t& num_nodes) {
+  return Count(position, depth, num_nodes, nullptr);
+}
+
+std::uint64_t Perft::Count(Position& position, int depth,
+                           std::uint64_t& num_nodes, HashTable* table) {
+  ++num_nodes;
+  if (depth == 0) {
+    return 1;
+  }
+  if (position.IsDrawn()) {
+    return 0;
+  }
+  std::uint64_t key{};
+  std::uint64_t num_leaves{};
+  if (table && (depth >= kMinHashDepth)) {
+    key = HashTable::ToKey(position);
+    if (table->Probe(key, depth, num_leaves)) {
+      return num_leaves;
+    }
+  }
+  Position::MoveList moves;
+  position.GenerateMoves(moves);
+  for (const auto& move : moves) {
+    auto undo = position.DoMove(move);
+    num_leaves += Count(position, GetNextDepth(position, depth), num_nodes,
+                        table);
+    position.UndoMove(undo);
+  }
+  if (table && (depth >= kMinHashDepth)) {
+    table->Store(key, depth, num_leaves);
+  }
+  return num_leaves;
+}
+
+Perft::Perft(const Options& options) : position_{ToPosition(options)} {}
+
+Perft::Perft(const Position& position) : position_{position} {}
+
+Perft::Result Perft::Run(int depth, const Settings& settings) const {
+  std::vector<DivideItem> items;
+  return Run(depth, settings, items);
+}
+
+Perft::Result Perft::Run(int depth, const Settings& settings,
+                         std::vector<DivideItem>& items) const {
+  Result result;
+  auto start = std::chrono::steady_clock::now();
+  items.clear();
+  if (depth <= 0) {
+    auto position = position_;
+    result.num_leaves = Count(position, depth, result.num_nodes);
+  } else {
+    items = Divide(depth, settings, result.num_nodes);
+    for (const auto& item : items) {
+      result.num_leaves += item.num_leaves;
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  return result;
+}
+
+std::vector<Perft::DivideItem> Perft::Divide(int depth,
+                                             const Settings& settings) const {
+  std::uint64_t num_nodes{};
+  return Divide(depth, settings, num_nodes);
+}
+
+std::vector<Perft::DivideItem> Perft::Divide(int depth,
+                                             const Settings& settings,
+                                             std::uint64_t& num_nodes) const {
+  std::vector<DivideItem> items;
+  ++num_nodes;
+  if ((depth <= 0) || position_.IsDrawn()) {
+    return items;
+  }
+  std::unique_ptr<HashTable> table;
+  if (settings.hash_megabytes > 0) {
+    table = std::make_unique<HashTable>(settings.hash_megabytes);
+  }
+  auto position = position_;
+  Position::MoveList moves;
+  position.GenerateMoves(moves);
+  items.reserve(moves.size());
+
+  if (settings.num_threads <= 1) {
+    for (const auto& move : moves) {
+      auto undo = position.DoMove(move);
+      items.push_back(DivideItem{
+        move, Count(position, GetNextDepth(position, depth), num_nodes,
+                    table.get())});
+      position.UndoMove(undo);
+    }
+    return items;
+  }
+
+  std::vector<std::atomic<std::uint64_t>> num_leaves(moves.size());
+  std::atomic<std::uint64_t> total_nodes{};
+  ThreadPool pool{settings.num_threads};
+  // Splits subtrees into further tasks until they are small enough to be
+  // counted sequentially; every task works on its own copy of the position.
+  std::function<void(Position, int, int)> expand =
+      [&](Position position, int depth, int root) {
+        if (depth <= kMaxTaskDepth) {
+          std::uint64_t task_nodes{};
+          num_leaves[root] += Count(position, depth, task_nodes, table.get());
+          total_nodes += task_nodes;
+          return;
+        }
+        total_nodes += 1;
+        if (position.IsDrawn()) {
+          return;
+        }
+        Position::MoveList moves;
+        position.GenerateMoves(moves);
+        for (const auto& move : moves) {
+          auto child = position;
+          child.DoMove(move);
+          auto child_depth = GetNextDepth(child, depth);
+          pool.Submit([&expand, child, child_depth, root] {
+            expand(child, child_depth, root);
+          });
+        }
+      };
+  for (int i{}; i < moves.size(); ++i) {
+    auto child = position;
+    child.DoMove(moves[i]);
+    auto child_depth = GetNextDepth(child, depth);
+    pool.Submit([&expand, child, child_depth, i] {
+      expand(child, child_depth, i);
+    });
+  }
+  pool.Wait();
+
+  num_nodes += total_nodes;
+  for (int i{}; i < moves.size(); ++i) {
+    items.push_back(DivideItem{moves[i], num_leaves[i]});
+  }
+  return items;
+}
+
+}  // namespace checkers_style_game
@@ -0,0 +1,86 @@
+#ifndef SRC_PERFT_H_
+#define SRC_PERFT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "src/move_list.h"
+#include "src/options.h"
+#include "src/position.h"
+
+namespace checkers_style_game {
+
+// Move-generator correctness and performance gate. Enumerates all legal
+// move sequences from the start position of Options, or from a given
+// Position, where a multi-jump counts as a single ply together with all of
+// its continuations, and a game drawn by the number of sequential moves has
+// no further moves. perft_check_main verifies the counts against Engine.
+//
+// With more than one thread, the tree is split into subtrees, which run on
+// a work-stealing ThreadPool, each task on its own copy of the position.
+// An optional lock-free hash of (position key, depth) -> leaf count, shared
+// by all threads, deduplicates transpositions.
+class Perft final {
+ public:
+  struct Result final {
+    std::uint64_t num_leaves{};
+    std::uint64_t num_nodes{};
+    double seconds{};
+
+    double GetNodesPerSecond() const {
+      return (seconds > 0) ? num_nodes / seconds : 0;
+    }
+  };
+
+  struct DivideItem final {
+    MoveRecord move;
+    std::uint64_t num_leaves{};
+  };
+
+  struct Settings final {
+    int num_threads{1};
+    // Size of the transposition hash; zero disables it.
+    std::size_t hash_megabytes{};
+  };
+
+  // Sets up the position of options as Engine::StartGame does, up to the
+  // point where StartGame plays the only command of a side with a single
+  // move or take. Perft does not play it, so its counts then start one
+  // command earlier than a game started through Engine.
+  static Position ToPosition(const Options& options);
+
+  // Counts the leaves at depth below position, which is restored on return.
+  static std::uint64_t Count(Position& position, int depth,
+                             std::uint64_t& num_nodes);
+
+  explicit Perft(const Options& options);
+  explicit Perft(const Position& position);
+
+  Result Run(int depth) const { return Run(depth, Settings{}); }
+  Result Run(int depth, const Settings& settings) const;
+  // Run, which also reports the divide of the same search.
+  Result Run(int depth, const Settings& settings,
+             std::vector<DivideItem>& items) const;
+  // Leaf counts per root move, in generation order.
+  std::vector<DivideItem> Divide(int depth) const {
+    return Divide(depth, Settings{});
+  }
+  std::vector<DivideItem> Divide(int depth, const Settings& settings) const;
+
+ private:
+  class HashTable;
+
+  static std::uint64_t Count(Position& position, int depth,
+                             std::uint64_t& num_nodes, HashTable* table);
+
+  // Divide, which also reports the total number of nodes.
+  std::vector<DivideItem> Divide(int depth, const Settings& settings,
+                                 std::uint64_t& num_nodes) const;
+
+  Position position_;
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_PERFT_H_
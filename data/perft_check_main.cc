@@ -0,0 +1,227 @@
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/bitboard.h"
+#include "src/board.h"
+#include "src/common.h"
+#include "src/config.h"
+#include "src/coord.h"
+#include "src/engine.h"
+#include "src/options.h"
+#include "src/perft.h"
+
+using checkers_style_game::BitBoard;
+using checkers_style_game::Board;
+using checkers_style_game::Config;
+using checkers_style_game::Coord;
+using checkers_style_game::Engine;
+using checkers_style_game::GameType;
+using checkers_style_game::MoveDirection;
+using checkers_style_game::Options;
+using checkers_style_game::Perft;
+using checkers_style_game::Side;
+
+namespace {
+
+// Leaf counts of the start position for depths 1, 2, ... with the default
+// Options. They agree with the published perft of English draughts, whose
+// rules coincide with ours that far from the end of a game.
+constexpr std::uint64_t kReferenceLeaves[] = {
+  7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564
+};
+
+class NullObserver final : public Engine::Observer {
+ public:
+  void OnGameStarted(int) override {}
+  void OnGameUpdated(Side, const Board::Data&) override {}
+  void OnGameEnded(Side) override {}
+};
+
+class NullLogger final : public Engine::Logger {
+ public:
+  void Log(Level, const std::string&) override {}
+};
+
+struct Turn final {
+  Coord coord;
+  MoveDirection direction;
+  bool is_take;
+};
+
+// Enumerates the turns as Engine offers them: the continuation, which
+// AfterTake(coord) returns, otherwise the takes, otherwise the moves of
+// Proceed, including the lone-piece restriction of GetAutoCommands.
+std::vector<Turn> GetTurns(Engine& engine, Side side, const Coord* jumper,
+                           bool has_lone_piece_rule) {
+  std::vector<Turn> turns;
+  for (int x{1}; x <= Config::kBoardSize; ++x) {
+    for (int y{1}; y <= Config::kBoardSize; ++y) {
+      if (jumper && ((jumper->x() != x) || (jumper->y() != y))) {
+        continue;
+      }
+      for (auto dir : BitBoard::kDirections) {
+        if (engine.CanTake(x, y, dir)) {
+          turns.push_back(Turn{Coord{x, y}, dir, true});
+        }
+      }
+    }
+  }
+  if (jumper || !turns.empty()) {
+    return turns;
+  }
+  auto coords = engine.GetCoords(side);
+  if (has_lone_piece_rule && (coords.size() == 1)) {
+    for (const auto& cmd : engine.GetAutoCommands(coords.front())) {
+      turns.push_back(Turn{cmd->coord(), cmd->direction(), false});
+    }
+    return turns;
+  }
+  for (int x{1}; x <= Config::kBoardSize; ++x) {
+    for (int y{1}; y <= Config::kBoardSize; ++y) {
+      for (auto dir : BitBoard::kDirections) {
+        if (engine.CanMove(x, y, dir)) {
+          turns.push_back(Turn{Coord{x, y}, dir, false});
+        }
+      }
+    }
+  }
+  return turns;
+}
+
+// Plays turn through Engine. Returns the square of the piece, if the turn
+// continues with a further take of it.
+std::optional<Coord> Play(Engine& engine, const Turn& turn) {
+  auto side = engine.GetPosition().side_to_move();
+  auto x = turn.coord.x();
+  auto y = turn.coord.y();
+  auto ok = turn.is_take ? engine.Take(x, y, turn.direction) :
+                           engine.Move(x, y, turn.direction);
+  if (!ok) {
+    throw std::logic_error{"Engine rejected a generated turn"};
+  }
+  if (!turn.is_take || (engine.GetPosition().side_to_move() != side)) {
+    return std::nullopt;
+  }
+  return Coord{x + 2 * checkers_style_game::Dx(turn.direction),
+               y + 2 * checkers_style_game::Dy(turn.direction)};
+}
+
+// Perft::Count, driven by Engine commands: a game, which Engine ends, has
+// no further turns.
+std::uint64_t Count(Engine& engine, int depth, const Coord* jumper,
+                    bool has_lone_piece_rule) {
+  if (depth == 0) {
+    return 1;
+  }
+  auto side = engine.GetPosition().side_to_move();
+  if ((side != Side::kLight) && (side != Side::kDark)) {
+    return 0;
+  }
+  std::uint64_t num_leaves{};
+  for (const auto& turn : GetTurns(engine, side, jumper,
+                                   has_lone_piece_rule)) {
+    if (auto next = Play(engine, turn)) {
+      num_leaves += Count(engine, depth, &*next, has_lone_piece_rule);
+    } else {
+      num_leaves += Count(engine, depth - 1, nullptr, has_lone_piece_rule);
+    }
+    engine.Revert();
+  }
+  return num_leaves;
+}
+
+}  // namespace
+
+// Cross-checks Perft against Engine's own move and take generation: on the
+// start position against the reference counts, then on positions reached
+// by random play. Fails on the first difference.
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <depth> <num_samples> [<seed> [analysis]]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  int depth{};
+  int num_samples{};
+  unsigned long seed{1};
+  try {
+    depth = std::stoi(argv[1]);
+    num_samples = std::stoi(argv[2]);
+    if (argc > 3) {
+      seed = std::stoul(argv[3]);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Invalid argument - (" << e.what() << ")" << std::endl;
+    return EXIT_FAILURE;
+  }
+  Options options;
+  options.game_type = ((argc > 4) && (std::string{argv[4]} == "analysis")) ?
+      GameType::kAnalysis : GameType::kHumanHuman;
+  auto has_lone_piece_rule = GameType::kAnalysis != options.game_type;
+
+  NullObserver observer;
+  NullLogger logger;
+  auto engine = Engine::Create(observer, logger);
+  engine->StartGame(&options);
+
+  auto compare = [&](int d, const char* label) {
+    auto expected = Count(*engine, d, nullptr, has_lone_piece_rule);
+    auto actual = Perft{engine->GetPosition()}.Run(d).num_leaves;
+    std::cout << label << " depth " << d << ": " << actual << '\n';
+    if (actual != expected) {
+      std::cerr << "Perft counts " << actual << " leaves, Engine "
+                << expected << std::endl;
+      return false;
+    }
+    return true;
+  };
+
+  for (int d{1}; d <= depth; ++d) {
+    if (!compare(d, "Start")) {
+      return EXIT_FAILURE;
+    }
+    auto num_leaves = Perft{options}.Run(d).num_leaves;
+    if (has_lone_piece_rule &&
+        (d <= static_cast<int>(std::size(kReferenceLeaves))) &&
+        (num_leaves != kReferenceLeaves[d - 1])) {
+      std::cerr << "Perft counts " << num_leaves << " leaves, reference "
+                << kReferenceLeaves[d - 1] << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::mt19937_64 rng{seed};
+  for (int n{}; n < num_samples; ++n) {
+    engine->StartGame(&options);
+    // Plays a random number of whole turns, then compares from there.
+    auto num_turns = static_cast<int>(rng() % 60);
+    for (int i{}; i < num_turns; ++i) {
+      std::optional<Coord> jumper;
+      do {
+        auto side = engine->GetPosition().side_to_move();
+        if ((side != Side::kLight) && (side != Side::kDark)) {
+          break;
+        }
+        auto turns = GetTurns(*engine, side, jumper ? &*jumper : nullptr,
+                              has_lone_piece_rule);
+        if (turns.empty()) {
+          break;
+        }
+        jumper = Play(*engine, turns[rng() % turns.size()]);
+      } while (jumper);
+    }
+    if (!compare(depth, "Sample")) {
+      return EXIT_FAILURE;
+    }
+  }
+  std::cout << "Mismatches: 0" << std::endl;
+  return EXIT_SUCCESS;
+}
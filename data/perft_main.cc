@@ -0,0 +1,141 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/bitboard.h"
+#include "src/common.h"
+#include "src/config.h"
+#include "src/coord.h"
+#include "src/options.h"
+#include "src/perft.h"
+#include "src/position.h"
+
+using checkers_style_game::BitBoard;
+using checkers_style_game::Config;
+using checkers_style_game::Level;
+using checkers_style_game::Options;
+using checkers_style_game::Perft;
+using checkers_style_game::Position;
+using checkers_style_game::Side;
+
+namespace {
+
+// Parses "<row 1>/.../<row N> <side> [<num_seq_moves>]", where row x lists
+// the squares (x, 1)..(x, N) as '.' (empty), 'l'/'L' (light man/king) or
+// 'd'/'D' (dark man/king), and side is 'l' or 'd'.
+Position ToPosition(const std::string& text) {
+  std::istringstream iss{text};
+  std::string rows;
+  std::string side;
+  int num_seq_moves{};
+  iss >> rows >> side;
+  if (!(iss >> num_seq_moves)) {
+    num_seq_moves = 0;
+  }
+  if (((side != "l") && (side != "d")) || (num_seq_moves < 0) ||
+      (num_seq_moves >= checkers_style_game::kMaxNumSeqMoves)) {
+    std::ostringstream oss;
+    oss << "(" << text << ")";
+    throw std::invalid_argument{"Invalid position - " + oss.str()};
+  }
+
+  BitBoard board;
+  int x{1};
+  int y{1};
+  for (auto c : rows) {
+    if (c == '/') {
+      if (y != Config::kBoardSize + 1) {
+        break;
+      }
+      ++x;
+      y = 1;
+      continue;
+    }
+    if ((x > Config::kBoardSize) || (y > Config::kBoardSize)) {
+      break;
+    }
+    auto square = BitBoard::ToSquare(x, y++);
+    switch (c) {
+      case '.':
+        break;
+      case 'l':
+        board.Put(square, Side::kLight, Level::kMan);
+        break;
+      case 'L':
+        board.Put(square, Side::kLight, Level::kKing);
+        break;
+      case 'd':
+        board.Put(square, Side::kDark, Level::kMan);
+        break;
+      case 'D':
+        board.Put(square, Side::kDark, Level::kKing);
+        break;
+      default:
+        y = Config::kBoardSize + 2;
+        break;
+    }
+  }
+  if ((x != Config::kBoardSize) || (y != Config::kBoardSize + 1)) {
+    std::ostringstream oss;
+    oss << "(" << rows << ")";
+    throw std::invalid_argument{"Invalid board - " + oss.str()};
+  }
+  return Position{board, (side == "l") ? Side::kLight : Side::kDark,
+                  num_seq_moves};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0]
+              << " <depth> [<num_threads> [<hash_megabytes> [<position>]]]"
+              << std::endl
+              << "  position: \"<row 1>/.../<row " << Config::kBoardSize
+              << "> <l|d> [<num_seq_moves>]\", squares as . l L d D"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int depth{};
+  Perft::Settings settings;
+  try {
+    depth = std::stoi(argv[1]);
+    if (argc > 2) {
+      settings.num_threads = std::stoi(argv[2]);
+    }
+    if (argc > 3) {
+      settings.hash_megabytes = std::stoul(argv[3]);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Invalid argument - (" << e.what() << ")" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Perft::DivideItem> items;
+  Perft::Result result;
+  try {
+    auto perft = (argc > 4) ? Perft{ToPosition(argv[4])} : Perft{Options{}};
+    result = perft.Run(depth, settings, items);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (const auto& item : items) {
+    auto coord = BitBoard::ToCoord(item.move.square);
+    std::cout << "(x=" << coord.x() << ",y=" << coord.y() << ") -> "
+              << checkers_style_game::Stringify(item.move.direction) << ": "
+              << item.num_leaves << '\n';
+  }
+  std::cout << "Depth: " << depth << '\n'
+            << "Leaves: " << result.num_leaves << '\n'
+            << "Nodes: " << result.num_nodes << '\n'
+            << "Seconds: " << result.seconds << '\n'
+            << "Nodes/s: " << static_cast<long long>(
+                   result.GetNodesPerSecond()) << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+#include "src/ponderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "src/common.h"
+#include "src/move_list.h"
+#include "src/position.h"
+#include "src/search.h"
+#include "src/time_manager.h"
+
+namespace checkers_style_game {
+
+namespace {
+
+// Interval, at which Finish polls the limits of the search.
+constexpr std::chrono::milliseconds kPollInterval{1};
+
+}  // namespace
+
+bool Ponderer::Predict(const Position& root,
+                       const std::vector<MoveRecord>& pv, Position& position) {
+  position = root;
+  auto side = root.side_to_move();
+  auto it = pv.begin();
+  // Own turn, then the opponent's turn, each possibly a multi-jump.
+  for (auto turn_side : {side, Reverse(side)}) {
+    while ((it != pv.end()) && (position.side_to_move() == turn_side)) {
+      if (!position.IsLegal(*it)) {
+        return false;
+      }
+      position.DoMove(*it++);
+    }
+  }
+  return (position.side_to_move() == side) && !position.IsDrawn();
+}
+
+void Ponderer::Start(const Position& position, const Search::Limits& limits) {
+  Cancel();
+  key_ = position.hash();
+  side_to_move_ = position.side_to_move();
+  is_stopped_ = false;
+  auto ponder_limits = limits;
+  ponder_limits.depth = Search::kMaxDepth;
+  ponder_limits.nodes = 0;
+  ponder_limits.time = TimeManager::Settings{};
+  ponder_limits.stop = &is_stopped_;
+  ponder_limits.owner_stop = nullptr;
+  search_ = std::make_unique<Search>(table_);
+  result_ = std::async(std::launch::async,
+                       [search = search_.get(), position, ponder_limits] {
+                         return search->Run(position, ponder_limits);
+                       });
+}
+
+void Ponderer::Cancel() {
+  if (!is_pondering()) {
+    return;
+  }
+  is_stopped_ = true;
+  result_.get();
+  search_.reset();
+  side_to_move_ = Side::kUnset;
+}
+
+Search::Result Ponderer::Finish(const Search::Limits& limits) {
+  TimeManager time_manager;
+  time_manager.Start(limits.time);
+  auto depth = std::clamp(limits.depth, 1, Search::kMaxDepth);
+  while (result_.wait_for(kPollInterval) != std::future_status::ready) {
+    if (time_manager.IsSoftExpired() || limits.IsStopRequested() ||
+        (search_->completed_depth() >= depth) ||
+        (limits.nodes && (search_->num_nodes() >= limits.nodes))) {
+      is_stopped_ = true;
+    }
+  }
+  auto result = result_.get();
+  search_.reset();
+  side_to_move_ = Side::kUnset;
+  return result;
+}
+
+}  // namespace checkers_style_game
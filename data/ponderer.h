@@ -0,0 +1,67 @@
+#ifndef SRC_PONDERER_H_
+#define SRC_PONDERER_H_
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "src/common.h"
+#include "src/move_list.h"
+#include "src/position.h"
+#include "src/search.h"
+#include "src/transposition_table.h"
+
+namespace checkers_style_game {
+
+// Searches on the opponent's time: while the opponent considers its reply,
+// the position after the reply predicted by the principal variation is
+// searched on a background thread. If the actual reply matches (a hit),
+// that search goes on as the search of the next move, otherwise (a miss)
+// it gets cancelled. Either way, the shared transposition table keeps what
+// has been found.
+class Ponderer final {
+ public:
+  using Key = Position::Key;
+
+  // Plays pv from root up to the end of the opponent's reply, i.e. until
+  // it is the turn of the side to move at root again. Returns false, if pv
+  // ends before.
+  static bool Predict(const Position& root, const std::vector<MoveRecord>& pv,
+                      Position& position);
+
+  explicit Ponderer(TranspositionTable& table) : table_{table} {}
+  ~Ponderer() { Cancel(); }
+
+  Ponderer(const Ponderer&) = delete;
+  Ponderer& operator=(const Ponderer&) = delete;
+
+  bool is_pondering() const { return result_.valid(); }
+  Side side_to_move() const { return side_to_move_; }
+
+  // Whether position is the one being searched.
+  bool IsHit(const Position& position) const {
+    return is_pondering() && (position.hash() == key_);
+  }
+
+  // Starts searching position with limits, without a time, depth or node
+  // limit. Cancels the previous search, if any.
+  void Start(const Position& position, const Search::Limits& limits);
+  void Cancel();
+
+  // Lets the search of a hit go on within the time, depth, node and stop
+  // limits of limits, then returns its result.
+  Search::Result Finish(const Search::Limits& limits);
+
+ private:
+  TranspositionTable& table_;
+  std::unique_ptr<Search> search_;
+  std::future<Search::Result> result_;
+  std::atomic<bool> is_stopped_{};
+  Key key_{};
+  Side side_to_move_{Side::kUnset};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_PONDERER_H_
@@ -0,0 +1,8 @@
+#include "src/position.h"
+
+namespace checkers_style_game {
+
+template class BasicPosition<8>;
+template class BasicPosition<10>;
+
+}  // namespace checkers_style_game
@@ -0,0 +1,260 @@
+#ifndef SRC_POSITION_H_
+#define SRC_POSITION_H_
+
+#include "src/bitboard.h"
+#include "src/common.h"
+#include "src/config.h"
+#include "src/geometry.h"
+#include "src/move_list.h"
+#include "src/zobrist.h"
+
+namespace checkers_style_game {
+
+// Lightweight game state for search and analysis: the bitboard, the side to
+// move, the number of sequential moves and the piece in the middle of a
+// multi-jump, if any. DoMove and UndoMove only mutate this state and its
+// hash; there are no observer callbacks, no logging and no follow-up
+// Proceed. A man which gets promoted ends the turn, even if it could take
+// further.
+//
+// Outside of GameType::kAnalysis, Engine::Proceed restricts a side, which
+// is down to a single piece and has no take, to the moves, which do not
+// hand over a take (see Engine::GetAutoCommands); with no such move, the
+// side loses. The position applies the same lone-piece rule, unless it
+// is constructed without it.
+template <int kSize>
+class BasicPosition final {
+ public:
+  using BitBoard = BasicBitBoard<kSize>;
+  using Geometry = typename BitBoard::Geometry;
+  using Zobrist = typename BitBoard::Zobrist;
+  using MoveList = typename BitBoard::MoveList;
+  using Key = typename Zobrist::Key;
+
+  static constexpr int kNoJumper = -1;
+
+  // Everything that DoMove overwrites and UndoMove needs to restore.
+  struct Undo final {
+    MoveRecord move;
+    Side side_to_move{Side::kUnset};
+    int num_seq_moves{};
+    int jumper{kNoJumper};
+    Side taken_side{Side::kUnset};
+    Level taken_level{Level::kMan};
+    bool is_promoted{};
+  };
+
+  static constexpr int GetTarget(int square, MoveDirection dir, int distance) {
+    auto i = Geometry::ToDirectionIndex(dir);
+    return square + distance * (Geometry::kDx[i] * kSize + Geometry::kDy[i]);
+  }
+
+  BasicPosition() = default;
+  // jumper is the square of the piece, which has to continue a multi-jump.
+  BasicPosition(const BitBoard& board, Side side_to_move, int num_seq_moves,
+                bool has_lone_piece_rule = true, int jumper = kNoJumper)
+      : board_{board}, side_to_move_{side_to_move},
+        num_seq_moves_{num_seq_moves}, jumper_{jumper},
+        has_lone_piece_rule_{has_lone_piece_rule} {}
+
+  const BitBoard& board() const { return board_; }
+  Side side_to_move() const { return side_to_move_; }
+  int num_seq_moves() const { return num_seq_moves_; }
+  int jumper() const { return jumper_; }
+  bool has_lone_piece_rule() const { return has_lone_piece_rule_; }
+
+  Key hash() const {
+    return board_.hash() ^ Zobrist::GetSideKey(side_to_move_) ^
+           Zobrist::GetSeqMovesKey(num_seq_moves_) ^
+           ((jumper_ != kNoJumper) ? Zobrist::GetJumperKey(jumper_) : Key{}) ^
+           (has_lone_piece_rule_ ? Key{} : Zobrist::GetAnalysisKey());
+  }
+
+  // Whether the game is drawn by the number of sequential moves.
+  bool IsDrawn() const { return num_seq_moves_ >= kMaxNumSeqMoves; }
+
+  // Whether a take is pending, i.e. the side to move has to take.
+  bool MustTake() const {
+    return (jumper_ != kNoJumper) || board_.CanTake(side_to_move_);
+  }
+
+  // Whether the side to move has a legal move; otherwise it loses.
+  bool HasMoves() const;
+
+  // Appends the legal moves: the continuation of a multi-jump, otherwise
+  // the mandatory takes, otherwise the moves of the side to move, subject
+  // to the lone-piece rule.
+  void GenerateMoves(MoveList& moves) const;
+
+  // Whether move is among the ones GenerateMoves would append, e.g. for a
+  // move, which comes from a hash table.
+  bool IsLegal(const MoveRecord& move) const;
+
+  Undo DoMove(const MoveRecord& move);
+  void UndoMove(const Undo& undo);
+
+ private:
+  bool CanTakeFrom(int square) const;
+  // Whether the lone-piece rule restricts the moves of the side to move.
+  bool IsLonePiece() const;
+  // Whether a lone piece may make the move: it must not hand over a take,
+  // unless it draws the game by the number of sequential moves.
+  bool IsSafe(const MoveRecord& move) const;
+
+  BitBoard board_;
+  Side side_to_move_{Side::kUnset};
+  int num_seq_moves_{};
+  int jumper_{kNoJumper};
+  bool has_lone_piece_rule_{true};
+};
+
+template <int kSize>
+bool BasicPosition<kSize>::HasMoves() const {
+  if (MustTake()) {
+    return true;
+  }
+  if (!IsLonePiece()) {
+    return board_.CanMove(side_to_move_);
+  }
+  MoveList moves;
+  GenerateMoves(moves);
+  return !moves.empty();
+}
+
+template <int kSize>
+void BasicPosition<kSize>::GenerateMoves(MoveList& moves) const {
+  if (jumper_ != kNoJumper) {
+    auto mask = BitBoard::ToMask(jumper_);
+    for (auto dir : Geometry::kDirections) {
+      if (board_.GetTakers(side_to_move_, dir) & mask) {
+        moves.push_back(MoveRecord{static_cast<std::uint8_t>(jumper_), dir,
+                                   true});
+      }
+    }
+    return;
+  }
+  auto size = moves.size();
+  board_.GenerateTakes(side_to_move_, moves);
+  if (moves.size() != size) {
+    return;
+  }
+  board_.GenerateMoves(side_to_move_, moves);
+  if (IsLonePiece()) {
+    auto end = size;
+    for (auto i = size; i < moves.size(); ++i) {
+      if (IsSafe(moves[i])) {
+        moves[end++] = moves[i];
+      }
+    }
+    while (moves.size() > end) {
+      moves.pop_back();
+    }
+  }
+}
+
+template <int kSize>
+bool BasicPosition<kSize>::IsLegal(const MoveRecord& move) const {
+  if ((move.direction == MoveDirection::kUnset) ||
+      (move.square >= BitBoard::kNumSquares)) {
+    return false;
+  }
+  auto mask = BitBoard::ToMask(move.square);
+  if (move.is_take) {
+    return ((jumper_ == kNoJumper) || (jumper_ == move.square)) &&
+           (board_.GetTakers(side_to_move_, move.direction) & mask);
+  }
+  return (jumper_ == kNoJumper) && !board_.CanTake(side_to_move_) &&
+         (board_.GetMovers(side_to_move_, move.direction) & mask) &&
+         (!IsLonePiece() || IsSafe(move));
+}
+
+template <int kSize>
+typename BasicPosition<kSize>::Undo BasicPosition<kSize>::DoMove(
+    const MoveRecord& move) {
+  Undo undo{move, side_to_move_, num_seq_moves_, jumper_};
+  auto side = side_to_move_;
+  auto from = static_cast<int>(move.square);
+  auto to = GetTarget(from, move.direction, move.is_take ? 2 : 1);
+  auto is_man = !(board_.kings() & BitBoard::ToMask(from));
+
+  if (move.is_take) {
+    auto taken = GetTarget(from, move.direction, 1);
+    undo.taken_side = Reverse(side);
+    undo.taken_level = (board_.kings() & BitBoard::ToMask(taken)) ?
+                           Level::kKing : Level::kMan;
+    board_.Remove(taken);
+  }
+  board_.Relocate(from, to);
+  if (is_man && Geometry::IsEdgeRow(to / kSize + 1)) {
+    board_.Remove(to);
+    board_.Put(to, side, Level::kKing);
+    undo.is_promoted = true;
+  }
+
+  jumper_ = kNoJumper;
+  if (move.is_take) {
+    num_seq_moves_ = 0;
+    if (!undo.is_promoted && CanTakeFrom(to)) {
+      jumper_ = to;
+      return undo;
+    }
+  } else {
+    ++num_seq_moves_;
+  }
+  side_to_move_ = Reverse(side);
+  return undo;
+}
+
+template <int kSize>
+void BasicPosition<kSize>::UndoMove(const Undo& undo) {
+  auto from = static_cast<int>(undo.move.square);
+  auto to = GetTarget(from, undo.move.direction, undo.move.is_take ? 2 : 1);
+  if (undo.is_promoted) {
+    board_.Remove(to);
+    board_.Put(to, undo.side_to_move, Level::kMan);
+  }
+  board_.Relocate(to, from);
+  if (undo.move.is_take) {
+    board_.Put(GetTarget(from, undo.move.direction, 1), undo.taken_side,
+               undo.taken_level);
+  }
+  side_to_move_ = undo.side_to_move;
+  num_seq_moves_ = undo.num_seq_moves;
+  jumper_ = undo.jumper;
+}
+
+template <int kSize>
+bool BasicPosition<kSize>::CanTakeFrom(int square) const {
+  auto mask = BitBoard::ToMask(square);
+  for (auto dir : Geometry::kDirections) {
+    if (board_.GetTakers(side_to_move_, dir) & mask) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int kSize>
+bool BasicPosition<kSize>::IsLonePiece() const {
+  return has_lone_piece_rule_ && (jumper_ == kNoJumper) &&
+         (BitBoard::PopCount(board_.pieces(side_to_move_)) == 1);
+}
+
+template <int kSize>
+bool BasicPosition<kSize>::IsSafe(const MoveRecord& move) const {
+  if (num_seq_moves_ + 1 >= kMaxNumSeqMoves) {
+    return true;
+  }
+  auto board = board_;
+  board.Relocate(move.square, GetTarget(move.square, move.direction, 1));
+  return !board.CanTake(Reverse(side_to_move_));
+}
+
+extern template class BasicPosition<8>;
+extern template class BasicPosition<10>;
+
+using Position = BasicPosition<Config::kBoardSize>;
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_POSITION_H_
@@ -0,0 +1,120 @@
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "src/bitboard.h"
+#include "src/common.h"
+#include "src/config.h"
+
+using checkers_style_game::BitBoard;
+using checkers_style_game::Config;
+using checkers_style_game::Level;
+using checkers_style_game::MoveDirection;
+using checkers_style_game::Side;
+
+namespace {
+
+// The recursion, which Engine::FindPromoPath used before CountPromoPaths:
+// the man steps from prev in dir on the board itself, without memoization.
+bool FindPromoPath(BitBoard& board, Side side, int prev, MoveDirection dir) {
+  if (!(board.GetMovers(side, dir) & BitBoard::ToMask(prev))) {
+    return false;
+  }
+  auto target = BitBoard::Shift(BitBoard::ToMask(prev), dir);
+  auto next = BitBoard::PopLowest(target);
+  auto x = BitBoard::ToCoord(next).x();
+  if ((x == 1) || (x == Config::kBoardSize)) {
+    return true;
+  }
+  board.Relocate(prev, next);
+  auto found = false;
+  if (!board.CanTake(checkers_style_game::Reverse(side))) {
+    for (auto next_dir : BitBoard::kDirections) {
+      if (FindPromoPath(board, side, next, next_dir)) {
+        found = true;
+        break;
+      }
+    }
+  }
+  board.Relocate(next, prev);
+  return found;
+}
+
+int CountPromoPaths(BitBoard board, Side side) {
+  int count{};
+  auto men = board.pieces(side, Level::kMan);
+  while (men) {
+    auto square = BitBoard::PopLowest(men);
+    for (auto dir : BitBoard::kDirections) {
+      if (FindPromoPath(board, side, square, dir)) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+}  // namespace
+
+// Compares BitBoard::CountPromoPaths with the former recursion on random
+// placements; fails on the first difference.
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <num_positions> [<seed>]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  long long num_positions{};
+  unsigned long seed{1};
+  try {
+    num_positions = std::stoll(argv[1]);
+    if (argc > 2) {
+      seed = std::stoul(argv[2]);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Invalid argument - (" << e.what() << ")" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937_64 rng{seed};
+  for (long long n{}; n < num_positions; ++n) {
+    BitBoard board;
+    // From sparse to crowded boards.
+    auto density = 1 + static_cast<int>(rng() % 6);
+    for (int square{}; square < BitBoard::kNumSquares; ++square) {
+      auto coord = BitBoard::ToCoord(square);
+      if (((coord.x() + coord.y()) % 2 == 0) ||
+          (static_cast<int>(rng() % 12) >= density)) {
+        continue;
+      }
+      auto side = (rng() % 2) ? Side::kLight : Side::kDark;
+      auto level = (rng() % 4) ? Level::kMan : Level::kKing;
+      // Men never stand on their promotion row.
+      auto x = coord.x();
+      if (x == ((side == Side::kLight) ? 1 : Config::kBoardSize)) {
+        level = Level::kKing;
+      }
+      board.Put(square, side, level);
+    }
+    for (auto side : {Side::kLight, Side::kDark}) {
+      auto expected = CountPromoPaths(board, side);
+      auto actual = board.CountPromoPaths(side);
+      if (expected != actual) {
+        std::cerr << "Mismatch at position " << n << " (light="
+                  << static_cast<std::uint64_t>(board.pieces(Side::kLight))
+                  << ",dark="
+                  << static_cast<std::uint64_t>(board.pieces(Side::kDark))
+                  << ",kings=" << static_cast<std::uint64_t>(board.kings())
+                  << "): " << actual << " instead of " << expected
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  std::cout << "Positions: " << num_positions << '\n'
+            << "Mismatches: 0" << std::endl;
+  return EXIT_SUCCESS;
+}
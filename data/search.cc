@@ -0,0 +1,369 @@
+#include "src/search.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/bitboard.h"
+#include "src/common.h"
+#include "src/config.h"
+#include "src/move_list.h"
+#include "src/move_picker.h"
+#include "src/position.h"
+#include "src/tablebase.h"
+#include "src/tablebase_prober.h"
+#include "src/time_manager.h"
+#include "src/transposition_table.h"
+
+namespace checkers_style_game {
+
+namespace {
+
+constexpr int kManValue = 100;
+constexpr int kKingValue = 150;
+constexpr int kAdvancementValue = 4;
+
+// Nodes, which a worker counts locally before it adds them to the total
+// and polls the deadline and the stop flag of the caller.
+constexpr std::uint64_t kNodesPerFlush = 1024;
+
+// The position hash keeps the number of sequential moves in buckets only.
+// Once a subtree of depth may reach the draw by that number, its score
+// depends on the exact number, which the key then includes.
+TranspositionTable::Key ToTableKey(const Position& position, int depth) {
+  TranspositionTable::Key key = position.hash();
+  if (position.num_seq_moves() + depth < kMaxNumSeqMoves) {
+    return key;
+  }
+  key += 0x9E3779B97F4A7C15ull * (position.num_seq_moves() + 1);
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+  return key ^ (key >> 31);
+}
+
+}  // namespace
+
+int Search::Evaluate(const Position& position) {
+  const auto& board = position.board();
+  int score{};
+  for (auto side : {Side::kLight, Side::kDark}) {
+    auto men = board.pieces(side, Level::kMan);
+    int value = kManValue * BitBoard::PopCount(men) +
+                kKingValue * BitBoard::PopCount(board.pieces(side,
+                                                             Level::kKing));
+    // Men head to the top (lower x) or to the bottom row.
+    auto is_heading_top =
+        BitBoard::Geometry::IsForward(side, MoveDirection::kTopLeft);
+    while (men) {
+      auto x = BitBoard::PopLowest(men) / Config::kBoardSize + 1;
+      value += kAdvancementValue *
+               (is_heading_top ? Config::kBoardSize - x : x - 1);
+    }
+    score += (side == position.side_to_move()) ? value : -value;
+  }
+  return score;
+}
+
+// Search state of one thread.
+class Search::Worker final {
+ public:
+  Worker(Search& search, int index) : search_{search}, index_{index} {}
+
+  // Deepens until the depth limit or until the search gets stopped.
+  Result Iterate(const Position& position);
+
+  std::uint64_t num_nodes() const { return num_nodes_; }
+
+ private:
+  int Negamax(Position& position, int depth, int ply, int alpha, int beta);
+  // Resolves pending takes, including the continuation of a multi-jump,
+  // before the position gets evaluated. There is no standing pat, since
+  // takes are mandatory.
+  int Quiesce(Position& position, int ply, int alpha, int beta);
+
+  // Returns false, if position is not in the tablebase.
+  bool ProbeTablebase(const Position& position, int& score) const;
+  void CountNode();
+  bool IsStopped();
+  void UpdatePv(int ply, const MoveRecord& move);
+
+  Search& search_;
+  const int index_;
+  std::uint64_t num_nodes_{};
+  MoveRecord root_move_;
+  MovePicker::Heuristics heuristics_;
+  std::array<std::array<MoveRecord, kMaxPly>, kMaxPly> pv_{};
+  std::array<int, kMaxPly> pv_length_{};
+};
+
+Search::Result Search::Run(const Position& position, const Limits& limits) {
+  limits_ = limits;
+  is_stopped_ = false;
+  num_nodes_ = 0;
+  completed_depth_ = 0;
+  time_manager_.Start(limits.time);
+  table_.NewSearch();
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  auto num_threads = limits.num_threads;
+  if (num_threads == 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  num_threads = std::max(num_threads, 1);
+  for (int i{}; i < num_threads; ++i) {
+    workers.push_back(std::make_unique<Worker>(*this, i));
+  }
+  std::vector<std::thread> helpers;
+  for (int i{1}; i < num_threads; ++i) {
+    helpers.emplace_back([&workers, &position, i] {
+      workers[i]->Iterate(position);
+    });
+  }
+  auto result = workers[0]->Iterate(position);
+  is_stopped_ = true;
+  for (auto& helper : helpers) {
+    helper.join();
+  }
+  result.nodes = 0;
+  for (const auto& worker : workers) {
+    result.nodes += worker->num_nodes();
+  }
+  return result;
+}
+
+Search::Result Search::Worker::Iterate(const Position& position) {
+  Result result;
+  auto root = position;
+  Position::MoveList moves;
+  root.GenerateMoves(moves);
+  if (moves.empty() || root.IsDrawn()) {
+    return result;
+  }
+  result.best_move = moves[0];
+  root_move_ = moves[0];
+
+  // Every other helper starts one ply deeper, so that the threads do not
+  // all search the same depth at the same time. A root in the tablebase
+  // only needs its moves probed.
+  auto max_depth = std::clamp(search_.limits_.depth, 1, kMaxDepth);
+  int tablebase_score{};
+  if (ProbeTablebase(root, tablebase_score)) {
+    max_depth = 1;
+  }
+  for (int depth{std::min(1 + (index_ % 2), max_depth)}; depth <= max_depth;
+       ++depth) {
+    auto score = Negamax(root, depth, 0, -kInfinity, kInfinity);
+    if (IsStopped()) {
+      break;
+    }
+    result.best_move = root_move_ = pv_[0][0];
+    result.score = score;
+    result.depth = depth;
+    result.pv.assign(pv_[0].begin(), pv_[0].begin() + pv_length_[0]);
+    if (index_ == 0) {
+      search_.completed_depth_ = depth;
+    }
+    if (IsWinScore(score) ||
+        ((index_ == 0) && search_.time_manager_.IsSoftExpired())) {
+      break;
+    }
+  }
+  return result;
+}
+
+bool Search::Worker::ProbeTablebase(const Position& position,
+                                    int& score) const {
+  const auto* tablebase = search_.limits_.tablebase;
+  if (!tablebase || (position.jumper() != Position::kNoJumper)) {
+    return false;
+  }
+  const auto& board = position.board();
+  if (BitBoard::PopCount(board.pieces(Side::kLight) |
+                         board.pieces(Side::kDark)) >
+      tablebase->max_pieces(position.has_lone_piece_rule())) {
+    return false;
+  }
+  // The fewer sequential moves a win needs to its next take, the higher it
+  // scores, so that the winning side makes progress before the number of
+  // sequential moves runs out, and the losing side delays it.
+  auto value = tablebase->Probe(position);
+  if (Tablebase::IsWin(value)) {
+    score = kTablebaseWinScore - Tablebase::ToNumSeqMoves(value);
+  } else if (Tablebase::IsLoss(value)) {
+    score = -kTablebaseWinScore + Tablebase::ToNumSeqMoves(value);
+  } else if (value == Tablebase::kDraw) {
+    score = 0;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void Search::Worker::CountNode() {
+  if ((++num_nodes_ % kNodesPerFlush) == 0) {
+    auto total = search_.num_nodes_.fetch_add(kNodesPerFlush,
+                                              std::memory_order_relaxed);
+    const auto& limits = search_.limits_;
+    if ((limits.nodes && (total + kNodesPerFlush >= limits.nodes)) ||
+        limits.IsStopRequested() ||
+        search_.time_manager_.IsHardExpired()) {
+      search_.is_stopped_ = true;
+    }
+  }
+}
+
+bool Search::Worker::IsStopped() {
+  return search_.is_stopped_.load(std::memory_order_relaxed);
+}
+
+void Search::Worker::UpdatePv(int ply, const MoveRecord& move) {
+  pv_[ply][ply] = move;
+  std::copy(pv_[ply + 1].begin() + ply + 1,
+            pv_[ply + 1].begin() + pv_length_[ply + 1],
+            pv_[ply].begin() + ply + 1);
+  pv_length_[ply] = pv_length_[ply + 1];
+}
+
+int Search::ToTableScore(int score, int ply) {
+  return (score >= kWinScore - kMaxPly) ? (score + ply) :
+         (score <= -kWinScore + kMaxPly) ? (score - ply) : score;
+}
+
+int Search::FromTableScore(int score, int ply) {
+  return (score >= kWinScore - kMaxPly) ? (score - ply) :
+         (score <= -kWinScore + kMaxPly) ? (score + ply) : score;
+}
+
+int Search::Worker::Negamax(Position& position, int depth, int ply, int alpha,
+                            int beta) {
+  if (depth <= 0) {
+    return Quiesce(position, ply, alpha, beta);
+  }
+  pv_length_[ply] = ply;
+  CountNode();
+  if (IsStopped() || position.IsDrawn()) {
+    return 0;
+  }
+  if (ply >= kMaxPly - 1) {
+    return Evaluate(position);
+  }
+  int tablebase_score{};
+  if ((ply > 0) && ProbeTablebase(position, tablebase_score)) {
+    return tablebase_score;
+  }
+
+  auto& table = search_.table_;
+  auto key = ToTableKey(position, depth);
+  TranspositionTable::Entry entry;
+  MoveRecord best_move = (ply == 0) ? root_move_ : MoveRecord{};
+  if (table.Probe(key, entry)) {
+    auto score = FromTableScore(entry.score, ply);
+    if ((ply > 0) && (entry.depth >= depth) &&
+        ((entry.bound == TranspositionTable::Bound::kExact) ||
+         ((entry.bound == TranspositionTable::Bound::kLower) &&
+          (score >= beta)) ||
+         ((entry.bound == TranspositionTable::Bound::kUpper) &&
+          (score <= alpha)))) {
+      return score;
+    }
+    if (ply > 0) {
+      best_move = entry.move;
+    }
+  }
+
+  auto bound = TranspositionTable::Bound::kUpper;
+  MovePicker picker{position, best_move, heuristics_, ply};
+  best_move = MoveRecord{};
+  MoveRecord move;
+  int num_moves{};
+  while (picker.Next(move)) {
+    ++num_moves;
+    auto side = position.side_to_move();
+    auto undo = position.DoMove(move);
+    // The key of the child at its own depth, which differs from the hash
+    // near the draw by the number of sequential moves; Quiesce does not
+    // probe the table.
+    auto is_same_side = position.side_to_move() == side;
+    auto next_depth = is_same_side ? depth : depth - 1;
+    if (next_depth > 0) {
+      table.Prefetch(ToTableKey(position, next_depth));
+    }
+    auto score = is_same_side ?
+        Negamax(position, next_depth, ply + 1, alpha, beta) :
+        -Negamax(position, next_depth, ply + 1, -beta, -alpha);
+    position.UndoMove(undo);
+    if (IsStopped()) {
+      return 0;
+    }
+    if (score > alpha) {
+      alpha = score;
+      best_move = move;
+      bound = TranspositionTable::Bound::kExact;
+      UpdatePv(ply, move);
+      if (alpha >= beta) {
+        bound = TranspositionTable::Bound::kLower;
+        if (!move.is_take) {
+          heuristics_.Update(position.side_to_move(), move, ply, depth);
+        }
+        break;
+      }
+    }
+  }
+  if (num_moves == 0) {
+    return -kWinScore + ply;
+  }
+  table.Store(key, TranspositionTable::Entry{
+      best_move, ToTableScore(alpha, ply), depth, bound});
+  return alpha;
+}
+
+int Search::Worker::Quiesce(Position& position, int ply, int alpha,
+                            int beta) {
+  pv_length_[ply] = ply;
+  CountNode();
+  if (IsStopped() || position.IsDrawn()) {
+    return 0;
+  }
+  int tablebase_score{};
+  if (ProbeTablebase(position, tablebase_score)) {
+    return tablebase_score;
+  }
+  if (!position.MustTake()) {
+    if (!position.HasMoves()) {
+      return -kWinScore + ply;
+    }
+    return Evaluate(position);
+  }
+  if (ply >= kMaxPly - 1) {
+    return Evaluate(position);
+  }
+
+  MovePicker picker{position, MoveRecord{}, heuristics_, ply};
+  MoveRecord move;
+  while (picker.Next(move)) {
+    auto side = position.side_to_move();
+    auto undo = position.DoMove(move);
+    auto score = (position.side_to_move() == side) ?
+        Quiesce(position, ply + 1, alpha, beta) :
+        -Quiesce(position, ply + 1, -beta, -alpha);
+    position.UndoMove(undo);
+    if (IsStopped()) {
+      return 0;
+    }
+    if (score > alpha) {
+      alpha = score;
+      UpdatePv(ply, move);
+      if (alpha >= beta) {
+        break;
+      }
+    }
+  }
+  return alpha;
+}
+
+}  // namespace checkers_style_game
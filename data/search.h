@@ -0,0 +1,112 @@
+#ifndef SRC_SEARCH_H_
+#define SRC_SEARCH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "src/move_list.h"
+#include "src/move_picker.h"
+#include "src/position.h"
+#include "src/tablebase_prober.h"
+#include "src/time_manager.h"
+#include "src/transposition_table.h"
+
+namespace checkers_style_game {
+
+// Negamax alpha-beta search with iterative deepening over Position. Every
+// step of a multi-jump is a ply of its own, which keeps the side to move and
+// does not consume depth. Scores are from the perspective of the side to
+// move, in hundredths of a man; a won position scores kWinScore less the
+// number of plies to the win.
+//
+// With more than one thread, helper threads search the same root at
+// staggered depths (Lazy SMP). They only communicate through the shared
+// transposition table, which lets the main thread finish its iterations
+// faster; the result is always the one of the main thread.
+//
+// With a tablebase, positions within its number of pieces are not searched
+// further: a won position scores kTablebaseWinScore less the number of
+// sequential moves to its next take, which keeps the winning side making
+// progress before the game is drawn by the number of sequential moves.
+class Search final {
+ public:
+  static constexpr int kMaxDepth = 64;
+  static constexpr int kMaxPly = MovePicker::kMaxPly;
+  static constexpr int kInfinity = 32000;
+  static constexpr int kWinScore = 30000;
+  static constexpr int kTablebaseWinScore = 20000;
+
+  struct Limits final {
+    int depth{kMaxDepth};
+    // Zero means no limit; counts the nodes of all threads.
+    std::uint64_t nodes{};
+    // Zero means one thread per hardware thread.
+    int num_threads{1};
+    TimeManager::Settings time;
+    // Optional flag of the caller, which stops the search once set.
+    const std::atomic<bool>* stop{};
+    // Optional flag of the owner of the search, e.g. of
+    // Engine::StopAnalysis, which stops it just as well.
+    const std::atomic<bool>* owner_stop{};
+    // Optional tablebase, which is probed instead of searching.
+    const TablebaseProber* tablebase{};
+
+    bool IsStopRequested() const {
+      return (stop && stop->load(std::memory_order_relaxed)) ||
+             (owner_stop && owner_stop->load(std::memory_order_relaxed));
+    }
+  };
+
+  struct Result final {
+    MoveRecord best_move;
+    int score{};
+    // Depth of the last completed iteration.
+    int depth{};
+    std::uint64_t nodes{};
+    std::vector<MoveRecord> pv;
+  };
+
+  // Static evaluation: material and the advancement of men.
+  static int Evaluate(const Position& position);
+
+  static bool IsWinScore(int score) {
+    return (score >= kWinScore - kMaxPly) || (score <= -kWinScore + kMaxPly);
+  }
+
+  explicit Search(TranspositionTable& table) : table_{table} {}
+
+  // Returns the result of the last completed iteration, or a default
+  // Result, if the position has no legal moves.
+  Result Run(const Position& position, const Limits& limits);
+
+  // Stops the running search; may be called from any thread.
+  void Stop() { is_stopped_ = true; }
+
+  // Progress of the running search, which may be polled from any thread:
+  // the depth of the last completed iteration and the nodes counted so far.
+  int completed_depth() const {
+    return completed_depth_.load(std::memory_order_relaxed);
+  }
+  std::uint64_t num_nodes() const {
+    return num_nodes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  class Worker;
+
+  // Win scores are stored relative to the position, not to the root.
+  static int ToTableScore(int score, int ply);
+  static int FromTableScore(int score, int ply);
+
+  TranspositionTable& table_;
+  Limits limits_;
+  TimeManager time_manager_;
+  std::atomic<bool> is_stopped_{};
+  std::atomic<std::uint64_t> num_nodes_{};
+  std::atomic<int> completed_depth_{};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_SEARCH_H_
@@ -0,0 +1,352 @@
+#include "src/tablebase.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "src/bitboard.h"
+#include "src/board.h"
+#include "src/common.h"
+#include "src/config.h"
+#include "src/move_list.h"
+#include "src/position.h"
+#include "src/thread_pool.h"
+
+namespace checkers_style_game {
+
+namespace {
+
+using BitBoard = Position::BitBoard;
+
+constexpr int kNoSeqMoves = std::numeric_limits<int>::max();
+
+// Squares, which a group of pieces may stand on, and the rank of every
+// square among them, or -1.
+struct SquareSet final {
+  std::vector<int> squares;
+  std::array<int, BitBoard::kNumSquares> ranks;
+};
+
+SquareSet ToSquareSet(const std::vector<int>& squares) {
+  SquareSet set;
+  set.squares = squares;
+  set.ranks.fill(-1);
+  for (int i{}; i < static_cast<int>(squares.size()); ++i) {
+    set.ranks[squares[i]] = i;
+  }
+  return set;
+}
+
+// Men never stand on the row, where they get promoted.
+SquareSet ToMenSquareSet(Side side) {
+  auto promo_x = BitBoard::Geometry::IsForward(side, MoveDirection::kTopLeft) ?
+                     1 : Config::kBoardSize;
+  std::vector<int> squares;
+  for (auto square : Tablebase::GetPlayableSquares()) {
+    if (BitBoard::ToCoord(square).x() != promo_x) {
+      squares.push_back(square);
+    }
+  }
+  return ToSquareSet(squares);
+}
+
+const SquareSet& GetSquareSet(Side side, Level level) {
+  static const SquareSet kKings = ToSquareSet(Tablebase::GetPlayableSquares());
+  static const SquareSet kLightMen = ToMenSquareSet(Side::kLight);
+  static const SquareSet kDarkMen = ToMenSquareSet(Side::kDark);
+  return (level == Level::kKing) ? kKings :
+         (side == Side::kLight) ? kLightMen : kDarkMen;
+}
+
+std::uint64_t Choose(int n, int k) {
+  static const auto kTable = [] {
+    constexpr int kMax = BitBoard::kNumSquares + 1;
+    std::vector<std::vector<std::uint64_t>> table(
+        kMax, std::vector<std::uint64_t>(kMax));
+    for (int i{}; i < kMax; ++i) {
+      table[i][0] = 1;
+      for (int j{1}; j <= i; ++j) {
+        table[i][j] = table[i - 1][j - 1] + ((j < i) ? table[i - 1][j] : 0);
+      }
+    }
+    return table;
+  }();
+  return ((k < 0) || (k > n)) ? 0 : kTable[n][k];
+}
+
+// Groups of pieces in index order.
+struct Group final {
+  Side side;
+  Level level;
+  int count;
+};
+
+std::array<Group, 4> ToGroups(const Tablebase::Signature& signature) {
+  return {Group{Side::kLight, Level::kMan, signature.light_men},
+          Group{Side::kLight, Level::kKing, signature.light_kings},
+          Group{Side::kDark, Level::kMan, signature.dark_men},
+          Group{Side::kDark, Level::kKing, signature.dark_kings}};
+}
+
+std::uint64_t GetGroupSize(const Group& group) {
+  return Choose(GetSquareSet(group.side, group.level).squares.size(),
+                group.count);
+}
+
+}  // namespace
+
+Tablebase::Signature Tablebase::Signature::Of(const BitBoard& board) {
+  return Signature{
+      BitBoard::PopCount(board.pieces(Side::kLight, Level::kMan)),
+      BitBoard::PopCount(board.pieces(Side::kLight, Level::kKing)),
+      BitBoard::PopCount(board.pieces(Side::kDark, Level::kMan)),
+      BitBoard::PopCount(board.pieces(Side::kDark, Level::kKing))};
+}
+
+std::string Tablebase::Signature::ToString() const {
+  std::ostringstream oss;
+  oss << "L" << light_men << light_kings << "D" << dark_men << dark_kings;
+  return oss.str();
+}
+
+bool Tablebase::Signature::operator<(const Signature& other) const {
+  return std::make_tuple(light_men, light_kings, dark_men, dark_kings) <
+         std::make_tuple(other.light_men, other.light_kings, other.dark_men,
+                         other.dark_kings);
+}
+
+bool Tablebase::Signature::operator==(const Signature& other) const {
+  return !(*this < other) && !(other < *this);
+}
+
+const std::vector<int>& Tablebase::GetPlayableSquares() {
+  // The squares of the colour, which the pieces of the start position
+  // stand on.
+  static const std::vector<int> kSquares = [] {
+    Board board;
+    board.Reset();
+    BitBoard bitboard;
+    bitboard.Reset(board);
+    auto occupied = bitboard.pieces(Side::kLight) |
+                    bitboard.pieces(Side::kDark);
+    auto coord = BitBoard::ToCoord(BitBoard::PopLowest(occupied));
+    auto parity = (coord.x() + coord.y()) % 2;
+    std::vector<int> squares;
+    for (int square{}; square < BitBoard::kNumSquares; ++square) {
+      auto c = BitBoard::ToCoord(square);
+      if ((c.x() + c.y()) % 2 == parity) {
+        squares.push_back(square);
+      }
+    }
+    return squares;
+  }();
+  return kSquares;
+}
+
+std::uint64_t Tablebase::GetSize(const Signature& signature) {
+  std::uint64_t size{2};
+  for (const auto& group : ToGroups(signature)) {
+    size *= GetGroupSize(group);
+  }
+  return size;
+}
+
+std::uint64_t Tablebase::ToIndex(const Signature& signature,
+                                 const Position& position) {
+  std::uint64_t index = (position.side_to_move() == Side::kDark) ? 1 : 0;
+  const auto& board = position.board();
+  for (const auto& group : ToGroups(signature)) {
+    const auto& set = GetSquareSet(group.side, group.level);
+    auto mask = board.pieces(group.side, group.level);
+    std::uint64_t rank{};
+    for (int i{1}; mask; ++i) {
+      rank += Choose(set.ranks[BitBoard::PopLowest(mask)], i);
+    }
+    index = index * GetGroupSize(group) + rank;
+  }
+  return index;
+}
+
+bool Tablebase::ToPosition(const Signature& signature, std::uint64_t index,
+                           Position& position, bool has_lone_piece_rule) {
+  auto groups = ToGroups(signature);
+  BitBoard board;
+  BitBoard::Mask occupied{};
+  for (auto it = groups.rbegin(); it != groups.rend(); ++it) {
+    const auto& set = GetSquareSet(it->side, it->level);
+    auto size = GetGroupSize(*it);
+    auto rank = index % size;
+    index /= size;
+    // Unranks the combination from its highest square down.
+    auto n = static_cast<int>(set.squares.size());
+    for (int i{it->count}; i > 0; --i) {
+      do {
+        --n;
+      } while (Choose(n, i) > rank);
+      rank -= Choose(n, i);
+      auto square = set.squares[n];
+      if (occupied & BitBoard::ToMask(square)) {
+        return false;
+      }
+      occupied |= BitBoard::ToMask(square);
+      board.Put(square, it->side, it->level);
+    }
+  }
+  position = Position{board, index ? Side::kDark : Side::kLight, 0,
+                      has_lone_piece_rule};
+  return true;
+}
+
+void Tablebase::Generate(int max_pieces, int num_threads) {
+  // Takes lead to classes with fewer pieces and promotions to classes with
+  // fewer men, so the classes of one level do not depend on each other.
+  std::map<std::pair<int, int>, std::vector<Signature>> levels;
+  for (int lm{}; lm <= max_pieces; ++lm) {
+    for (int lk{}; lm + lk <= max_pieces; ++lk) {
+      for (int dm{}; lm + lk + dm <= max_pieces; ++dm) {
+        for (int dk{}; lm + lk + dm + dk <= max_pieces; ++dk) {
+          Signature signature{lm, lk, dm, dk};
+          if ((lm + lk == 0) || (dm + dk == 0) || tables_.count(signature)) {
+            continue;
+          }
+          tables_[signature];
+          levels[{signature.GetNumPieces(), signature.GetNumMen()}]
+              .push_back(signature);
+        }
+      }
+    }
+  }
+
+  ThreadPool pool{num_threads};
+  for (const auto& level : levels) {
+    for (const auto& signature : level.second) {
+      auto& table = tables_[signature];
+      pool.Submit([this, signature, &table] { Solve(signature, table); });
+    }
+    pool.Wait();
+  }
+}
+
+Tablebase::Value Tablebase::Probe(const Position& position) const {
+  if ((position.jumper() != Position::kNoJumper) ||
+      (position.has_lone_piece_rule() != has_lone_piece_rule_)) {
+    return kUnknown;
+  }
+  auto signature = Signature::Of(position.board());
+  auto it = tables_.find(signature);
+  if ((it == tables_.end()) || it->second.empty()) {
+    return kUnknown;
+  }
+  return AtNumSeqMoves(it->second[ToIndex(signature, position)],
+                       position.num_seq_moves());
+}
+
+void Tablebase::Solve(const Signature& signature,
+                      std::vector<Value>& table) const {
+  auto size = GetSize(signature);
+  table.assign(size, kUnknown);
+
+  // Successors within the class, and what the successors of other classes
+  // (already solved) allow for: the fastest win, the slowest loss and
+  // whether a draw can be forced. Both count the sequential moves before
+  // the next take or the end of the game; positions of the class stand for
+  // none, their quiet successors for one.
+  std::vector<bool> is_open(size);
+  std::vector<std::uint64_t> offsets(size + 1);
+  std::vector<std::uint32_t> successors;
+  std::vector<int> min_win(size, kNoSeqMoves);
+  std::vector<int> max_loss(size, -1);
+  std::vector<bool> has_draw(size);
+
+  for (std::uint64_t i{}; i < size; ++i) {
+    offsets[i] = successors.size();
+    Position position;
+    if (!ToPosition(signature, i, position, has_lone_piece_rule_)) {
+      continue;
+    }
+    auto visit = [&](const Position& next) {
+      if (!next.board().pieces(next.side_to_move())) {
+        min_win[i] = 0;
+        return;
+      }
+      auto next_signature = Signature::Of(next.board());
+      if (next_signature == signature) {
+        successors.push_back(
+            static_cast<std::uint32_t>(ToIndex(signature, next)));
+        return;
+      }
+      // A take leads to a class of fewer pieces and resets the number of
+      // sequential moves, so it ends the count; a quiet move does so only
+      // by a promotion, which keeps counting.
+      auto value = tables_.at(next_signature)[ToIndex(next_signature, next)];
+      auto num_seq_moves = (next.num_seq_moves() == 0) ?
+          0 : ToNumSeqMoves(value) + next.num_seq_moves();
+      if (IsLoss(value)) {
+        min_win[i] = std::min(min_win[i], num_seq_moves);
+      } else if (IsWin(value)) {
+        max_loss[i] = std::max(max_loss[i], num_seq_moves);
+      } else {
+        has_draw[i] = true;
+      }
+    };
+    if (ForEachTurn(position, visit) == 0) {
+      // Without any move, the side to move has lost. Under the lone-piece
+      // rule, a lone piece, whose moves all hand over a take, may still make
+      // one of them, once it draws the game.
+      table[i] = ToLoss(
+          position.board().CanMove(position.side_to_move()) ? 1 : 0);
+      continue;
+    }
+    is_open[i] = true;
+  }
+  offsets[size] = successors.size();
+
+  // Iteration n assigns the wins and losses after n sequential moves,
+  // which only depend on the values of iterations before. Positions, which
+  // need kMaxNumSeqMoves or more of them, are drawn.
+  for (int n{}; n < kMaxNumSeqMoves; ++n) {
+    for (std::uint64_t i{}; i < size; ++i) {
+      if (!is_open[i]) {
+        continue;
+      }
+      auto win = min_win[i];
+      auto loss = max_loss[i];
+      // Lost, if every successor is a win for the opponent.
+      auto is_lost = !has_draw[i] && (win == kNoSeqMoves);
+      for (auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+        auto value = table[successors[j]];
+        if (IsLoss(value)) {
+          win = std::min(win, ToNumSeqMoves(value) + 1);
+          is_lost = false;
+        } else if (IsWin(value)) {
+          loss = std::max(loss, ToNumSeqMoves(value) + 1);
+        } else {
+          is_lost = false;
+        }
+      }
+      if (win <= n) {
+        table[i] = ToWin(win);
+      } else if (is_lost && (loss <= n)) {
+        table[i] = ToLoss(loss);
+      } else {
+        continue;
+      }
+      is_open[i] = false;
+    }
+  }
+
+  for (std::uint64_t i{}; i < size; ++i) {
+    if (is_open[i]) {
+      table[i] = kDraw;
+    }
+  }
+}
+
+}  // namespace checkers_style_game
@@ -0,0 +1,149 @@
+#ifndef SRC_TABLEBASE_H_
+#define SRC_TABLEBASE_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "src/common.h"
+#include "src/position.h"
+
+namespace checkers_style_game {
+
+// Endgame tablebase of all positions with up to a given number of pieces,
+// where both sides have at least one piece. Positions are grouped into
+// material classes by Signature and solved by retrograde analysis over
+// whole turns, i.e. a multi-jump is a single transition. Turns follow the
+// rules of Position, with or without the lone-piece rule, which the tables
+// of GameType::kAnalysis lack; a tablebase only holds the one or the other.
+//
+// Every quiet move, i.e. one without a take, raises the number of
+// sequential moves, and the game is drawn once it reaches kMaxNumSeqMoves;
+// only takes reset it. A win therefore has to reach the next take (or the
+// end of the game) in time. Values keep the number of sequential moves,
+// which this takes with best play, i.e. the winning side hurries to the
+// next take and the losing side delays it; AtNumSeqMoves turns it into the
+// value of a position, which already has a number of sequential moves.
+class Tablebase final {
+ public:
+  // Value of a position for the side to move, before any sequential move:
+  // positive values win and negative values lose, after |value| - 1
+  // sequential moves of both sides, which lead to the next take or to the
+  // end of the game.
+  using Value = std::int16_t;
+
+  static constexpr Value kDraw = 0;
+  static constexpr Value kUnknown = std::numeric_limits<Value>::min();
+
+  static constexpr Value ToWin(int num_seq_moves) {
+    return static_cast<Value>(num_seq_moves + 1);
+  }
+  static constexpr Value ToLoss(int num_seq_moves) {
+    return static_cast<Value>(-num_seq_moves - 1);
+  }
+  static constexpr bool IsWin(Value value) {
+    return (value > 0);
+  }
+  static constexpr bool IsLoss(Value value) {
+    return (value < 0) && (value != kUnknown);
+  }
+  // Number of sequential moves until the next take or the end of the
+  // game, for a win or a loss.
+  static constexpr int ToNumSeqMoves(Value value) {
+    return ((value > 0) ? value : -value) - 1;
+  }
+  // Value of a position, which has num_seq_moves sequential moves already:
+  // a win or a loss, which needs more of them than are left, is a draw.
+  static constexpr Value AtNumSeqMoves(Value value, int num_seq_moves) {
+    return ((IsWin(value) || IsLoss(value)) &&
+            (num_seq_moves + ToNumSeqMoves(value) >= kMaxNumSeqMoves)) ?
+        kDraw : value;
+  }
+
+  // Material class: the number of men and kings per side.
+  struct Signature final {
+    int light_men{};
+    int light_kings{};
+    int dark_men{};
+    int dark_kings{};
+
+    static Signature Of(const Position::BitBoard& board);
+
+    int GetNumPieces() const {
+      return light_men + light_kings + dark_men + dark_kings;
+    }
+    int GetNumMen() const { return light_men + dark_men; }
+
+    // E.g. "L10D02" for one light man against two dark kings.
+    std::string ToString() const;
+
+    bool operator<(const Signature& other) const;
+    bool operator==(const Signature& other) const;
+  };
+
+  // Perfect hash of the positions of a class: a combination of squares for
+  // every group of pieces and the side to move. Indices, where groups
+  // overlap, do not stand for a position.
+  static std::uint64_t GetSize(const Signature& signature);
+  static std::uint64_t ToIndex(const Signature& signature,
+                               const Position& position);
+  // Returns false, if index does not stand for a position.
+  static bool ToPosition(const Signature& signature, std::uint64_t index,
+                         Position& position, bool has_lone_piece_rule = true);
+
+  // Squares, which pieces may stand on.
+  static const std::vector<int>& GetPlayableSquares();
+
+  // Calls visit for every position at the end of a turn from position,
+  // which is restored on return. Returns the number of turns.
+  template <typename Visit>
+  static int ForEachTurn(Position& position, Visit&& visit);
+
+  explicit Tablebase(bool has_lone_piece_rule = true)
+      : has_lone_piece_rule_{has_lone_piece_rule} {}
+
+  bool has_lone_piece_rule() const { return has_lone_piece_rule_; }
+
+  // Solves all classes with up to max_pieces pieces. Classes, which do not
+  // depend on each other, are solved in parallel.
+  void Generate(int max_pieces, int num_threads);
+
+  const std::map<Signature, std::vector<Value>>& tables() const {
+    return tables_;
+  }
+
+  // Returns the value at the number of sequential moves of position, or
+  // kUnknown for a position of a class, which is not solved, in the middle
+  // of a multi-jump or under other rules than the tablebase.
+  Value Probe(const Position& position) const;
+
+ private:
+  void Solve(const Signature& signature, std::vector<Value>& table) const;
+
+  bool has_lone_piece_rule_{true};
+  std::map<Signature, std::vector<Value>> tables_;
+};
+
+template <typename Visit>
+int Tablebase::ForEachTurn(Position& position, Visit&& visit) {
+  Position::MoveList moves;
+  position.GenerateMoves(moves);
+  int num_turns{};
+  for (const auto& move : moves) {
+    auto undo = position.DoMove(move);
+    if (position.jumper() != Position::kNoJumper) {
+      num_turns += ForEachTurn(position, visit);
+    } else {
+      visit(position);
+      ++num_turns;
+    }
+    position.UndoMove(undo);
+  }
+  return num_turns;
+}
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_TABLEBASE_H_
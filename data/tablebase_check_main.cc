@@ -0,0 +1,273 @@
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/bitboard.h"
+#include "src/board.h"
+#include "src/common.h"
+#include "src/engine.h"
+#include "src/move_list.h"
+#include "src/options.h"
+#include "src/position.h"
+#include "src/tablebase.h"
+
+using checkers_style_game::BitBoard;
+using checkers_style_game::Board;
+using checkers_style_game::Engine;
+using checkers_style_game::GameType;
+using checkers_style_game::kMaxNumSeqMoves;
+using checkers_style_game::MoveRecord;
+using checkers_style_game::Options;
+using checkers_style_game::Position;
+using checkers_style_game::Side;
+using checkers_style_game::Tablebase;
+
+namespace {
+
+class ResultObserver final : public Engine::Observer {
+ public:
+  void OnGameStarted(int) override { side_that_wins_ = Side::kUnset; }
+  void OnGameUpdated(Side, const Board::Data&) override {}
+  void OnGameEnded(Side side_that_wins) override {
+    side_that_wins_ = side_that_wins;
+  }
+
+  Side side_that_wins() const { return side_that_wins_; }
+
+ private:
+  Side side_that_wins_{Side::kUnset};
+};
+
+class NullLogger final : public Engine::Logger {
+ public:
+  void Log(Level, const std::string&) override {}
+};
+
+// A turn: its moves and the position at its end.
+struct Turn final {
+  std::vector<MoveRecord> moves;
+  Position position;
+};
+
+void AppendTurns(Position& position, std::vector<MoveRecord>& moves,
+                 std::vector<Turn>& turns) {
+  Position::MoveList list;
+  position.GenerateMoves(list);
+  for (const auto& move : list) {
+    auto undo = position.DoMove(move);
+    moves.push_back(move);
+    if (position.jumper() != Position::kNoJumper) {
+      AppendTurns(position, moves, turns);
+    } else {
+      turns.push_back(Turn{moves, position});
+    }
+    moves.pop_back();
+    position.UndoMove(undo);
+  }
+}
+
+std::vector<Turn> GetTurns(Position position) {
+  std::vector<Turn> turns;
+  std::vector<MoveRecord> moves;
+  AppendTurns(position, moves, turns);
+  return turns;
+}
+
+// Value of the position at the end of a turn, as Engine decides it: the
+// game is drawn once the number of sequential moves runs out, before the
+// side to move gets to play, and lost for a side without pieces.
+Tablebase::Value GetValue(const Tablebase& tablebase,
+                          const Position& position) {
+  if (position.IsDrawn()) {
+    return Tablebase::kDraw;
+  }
+  if (!position.board().pieces(position.side_to_move())) {
+    return Tablebase::ToLoss(0);
+  }
+  return tablebase.Probe(position);
+}
+
+enum class Wdl { kWin, kDraw, kLoss };
+
+Wdl ToWdl(Tablebase::Value value) {
+  return Tablebase::IsWin(value) ? Wdl::kWin :
+         Tablebase::IsLoss(value) ? Wdl::kLoss : Wdl::kDraw;
+}
+
+// Result of a position from the results of its turns.
+Wdl GetExpectedWdl(const Tablebase& tablebase, const Position& position) {
+  auto turns = GetTurns(position);
+  auto wdl = Wdl::kLoss;
+  for (const auto& turn : turns) {
+    auto value = GetValue(tablebase, turn.position);
+    if (value == Tablebase::kUnknown) {
+      throw std::logic_error{"Successor not in the tablebase"};
+    }
+    if (ToWdl(value) == Wdl::kLoss) {
+      return Wdl::kWin;
+    }
+    if (ToWdl(value) == Wdl::kDraw) {
+      wdl = Wdl::kDraw;
+    }
+  }
+  return wdl;
+}
+
+// Every position at every number of sequential moves has to take the
+// result of its best turn. Quiet moves raise that number and takes lead to
+// fewer pieces, so turns never cycle, and the check covers all of the
+// tables.
+bool CheckSuccessors(const Tablebase& tablebase, std::uint64_t& count) {
+  for (const auto& [signature, table] : tablebase.tables()) {
+    for (std::uint64_t i{}; i < table.size(); ++i) {
+      Position base;
+      if (!Tablebase::ToPosition(signature, i, base,
+                                 tablebase.has_lone_piece_rule())) {
+        continue;
+      }
+      for (int num_seq_moves{}; num_seq_moves < kMaxNumSeqMoves;
+           ++num_seq_moves) {
+        Position position{base.board(), base.side_to_move(), num_seq_moves,
+                          tablebase.has_lone_piece_rule()};
+        auto expected = GetExpectedWdl(tablebase, position);
+        auto actual = ToWdl(tablebase.Probe(position));
+        ++count;
+        if (actual != expected) {
+          std::cerr << "Inconsistent value of " << signature.ToString()
+                    << " at index " << i << " after " << num_seq_moves
+                    << " sequential moves" << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void Play(Engine& engine, const Turn& turn) {
+  for (const auto& move : turn.moves) {
+    if (!engine.Play(move)) {
+      throw std::logic_error{"Engine rejected a generated move"};
+    }
+  }
+}
+
+// Turn along the tables: the fastest win, else a draw, else the slowest
+// loss. A take does not hurry, as it resets the sequential moves.
+const Turn& ChooseTurn(const Tablebase& tablebase,
+                       const std::vector<Turn>& turns) {
+  const Turn* best{};
+  int best_rank{std::numeric_limits<int>::min()};
+  for (const auto& turn : turns) {
+    auto value = GetValue(tablebase, turn.position);
+    auto num_seq_moves = (turn.position.num_seq_moves() == 0) ?
+        0 : Tablebase::ToNumSeqMoves(value);
+    auto rank = (ToWdl(value) == Wdl::kLoss) ? 2 * kMaxNumSeqMoves -
+                                                   num_seq_moves :
+                (ToWdl(value) == Wdl::kDraw) ? 0 : num_seq_moves -
+                                                   2 * kMaxNumSeqMoves;
+    if (rank > best_rank) {
+      best = &turn;
+      best_rank = rank;
+    }
+  }
+  return *best;
+}
+
+}  // namespace
+
+// Checks the tablebase against the rules, which it models: every value
+// against the values of its successors, then the predicted results of
+// endgames, which Engine reaches by random play, against the results of
+// Engine playing them out along the tables. Fails on the first difference.
+// With "analysis", the tables and Engine go without the lone-piece rule.
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <max_pieces> <num_samples> [<seed> [analysis]]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  int max_pieces{};
+  int num_samples{};
+  unsigned long seed{1};
+  try {
+    max_pieces = std::stoi(argv[1]);
+    num_samples = std::stoi(argv[2]);
+    if (argc > 3) {
+      seed = std::stoul(argv[3]);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Invalid argument - (" << e.what() << ")" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Options options;
+  options.game_type = ((argc > 4) && (std::string{argv[4]} == "analysis")) ?
+      GameType::kAnalysis : GameType::kHumanHuman;
+
+  Tablebase tablebase{GameType::kAnalysis != options.game_type};
+  tablebase.Generate(max_pieces, 1);
+  std::uint64_t num_positions{};
+  if (!CheckSuccessors(tablebase, num_positions)) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "Consistent positions: " << num_positions << std::endl;
+
+  ResultObserver observer;
+  NullLogger logger;
+  auto engine = Engine::Create(observer, logger);
+  std::mt19937_64 rng{seed};
+  int num_results[3]{};
+  for (int n{}; n < num_samples;) {
+    engine->StartGame(&options);
+    // Random turns until the game is within the tablebase, then some more,
+    // so that sequential moves add up.
+    auto num_extra_turns = static_cast<int>(rng() % kMaxNumSeqMoves);
+    Position position = engine->GetPosition();
+    while (observer.side_that_wins() == Side::kUnset) {
+      auto num_pieces = BitBoard::PopCount(
+          position.board().pieces(Side::kLight) |
+          position.board().pieces(Side::kDark));
+      if ((num_pieces <= max_pieces) && (num_extra_turns-- == 0)) {
+        break;
+      }
+      auto turns = GetTurns(position);
+      Play(*engine, turns[rng() % turns.size()]);
+      position = engine->GetPosition();
+    }
+    if (observer.side_that_wins() != Side::kUnset) {
+      continue;
+    }
+
+    auto value = tablebase.Probe(position);
+    auto side = position.side_to_move();
+    auto expected = Tablebase::IsWin(value) ? side :
+                    Tablebase::IsLoss(value) ? checkers_style_game::Reverse(
+                                                   side) :
+                                               Side::kNeutral;
+    while (observer.side_that_wins() == Side::kUnset) {
+      Play(*engine, ChooseTurn(tablebase, GetTurns(position)));
+      position = engine->GetPosition();
+    }
+    if (observer.side_that_wins() != expected) {
+      std::cerr << "Engine ends sample " << n << " with "
+                << checkers_style_game::Stringify(observer.side_that_wins())
+                << " instead of "
+                << checkers_style_game::Stringify(expected) << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++num_results[static_cast<int>(ToWdl(value))];
+    ++n;
+  }
+  std::cout << "Played out: " << num_results[0] << " wins, "
+            << num_results[1] << " draws, " << num_results[2] << " losses"
+            << std::endl;
+  return EXIT_SUCCESS;
+}
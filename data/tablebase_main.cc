@@ -0,0 +1,45 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "src/tablebase.h"
+#include "src/tablebase_prober.h"
+
+using checkers_style_game::Tablebase;
+using checkers_style_game::TablebaseProber;
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <max_pieces> <directory> [<num_threads>]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto max_pieces = std::stoi(argv[1]);
+  std::string directory{argv[2]};
+  auto num_threads = (argc > 3) ? std::stoi(argv[3]) : 1;
+
+  // The tables of GameType::kAnalysis go without the lone-piece rule.
+  for (auto has_lone_piece_rule : {true, false}) {
+    Tablebase tablebase{has_lone_piece_rule};
+    tablebase.Generate(max_pieces, num_threads);
+    TablebaseProber::Compress(tablebase, directory);
+
+    for (const auto& [signature, table] : tablebase.tables()) {
+      std::uint64_t wins{}, draws{}, losses{};
+      for (auto value : table) {
+        if (Tablebase::IsWin(value)) {
+          ++wins;
+        } else if (Tablebase::IsLoss(value)) {
+          ++losses;
+        } else if (value == Tablebase::kDraw) {
+          ++draws;
+        }
+      }
+      std::cout << signature.ToString()
+                << (has_lone_piece_rule ? "" : " (analysis)") << ": " << wins
+                << " wins, " << draws << " draws, " << losses << " losses"
+                << '\n';
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,389 @@
+#include "src/tablebase_prober.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "src/config.h"
+#include "src/position.h"
+#include "src/tablebase.h"
+
+namespace checkers_style_game {
+
+namespace {
+
+constexpr char kMagic[4] = {'C', 'S', 'T', 'Z'};
+constexpr std::uint32_t kVersion = 3;
+constexpr char kExtension[] = ".cstbz";
+
+// Layout of the header, without padding: magic, version, board size, the
+// four piece counts of the class, number of positions, positions per block,
+// number of blocks and whether the lone-piece rule applies. The offsets of
+// the blocks and of the end follow.
+constexpr std::size_t kHeaderSize = 4 + 4 + 4 + 4 * 4 + 8 + 4 + 4 + 4;
+
+// A symbol is one byte: loss, draw or win in the upper two bits, the number
+// of sequential moves of a win or a loss in the lower six. A run is two
+// bytes: the symbol and the length less one.
+static_assert(kMaxNumSeqMoves <= 64);
+constexpr int kMaxRunLength = 256;
+
+template <typename T>
+T Read(const char* data, std::size_t offset) {
+  T value;
+  std::memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void Append(std::string& bytes, const T& value) {
+  bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+std::uint8_t ToSymbol(Tablebase::Value value) {
+  auto wdl = Tablebase::IsWin(value) ? 2 : Tablebase::IsLoss(value) ? 0 : 1;
+  auto num_seq_moves = (wdl == 1) ? 0 : Tablebase::ToNumSeqMoves(value);
+  return static_cast<std::uint8_t>((wdl << 6) | num_seq_moves);
+}
+
+Tablebase::Value ToValue(std::uint8_t symbol) {
+  auto num_seq_moves = symbol & 63;
+  switch (symbol >> 6) {
+    case 0:
+      return Tablebase::ToLoss(num_seq_moves);
+    case 2:
+      return Tablebase::ToWin(num_seq_moves);
+    default:
+      return Tablebase::kDraw;
+  }
+}
+
+void AppendRuns(std::string& bytes, std::uint8_t symbol, int length) {
+  while (length > 0) {
+    auto run = std::min(length, kMaxRunLength);
+    bytes.push_back(static_cast<char>(symbol));
+    bytes.push_back(static_cast<char>(run - 1));
+    length -= run;
+  }
+}
+
+std::string EncodeBlock(const Tablebase::Value* values, int size) {
+  std::string bytes;
+  // Indices, which stand for no position, are never probed, so they
+  // extend whatever run they are in.
+  auto symbol = ToSymbol(Tablebase::kDraw);
+  auto it = std::find_if(values, values + size, [](auto value) {
+    return value != Tablebase::kUnknown;
+  });
+  if (it != values + size) {
+    symbol = ToSymbol(*it);
+  }
+  int length{};
+  for (int i{}; i < size; ++i) {
+    if (values[i] != Tablebase::kUnknown) {
+      auto next = ToSymbol(values[i]);
+      if (next != symbol) {
+        AppendRuns(bytes, symbol, length);
+        symbol = next;
+        length = 0;
+      }
+    }
+    ++length;
+  }
+  AppendRuns(bytes, symbol, length);
+  return bytes;
+}
+
+std::size_t GetShard(const std::pair<const void*, std::uint32_t>& key) {
+  auto hash = std::hash<const void*>{}(key.first) ^ key.second;
+  return static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ull) >> 60) %
+         TablebaseProber::kNumCacheShards;
+}
+
+}  // namespace
+
+// A class file, whose header gets read on construction of the prober and
+// whose contents get mapped on the first probe of its class.
+struct TablebaseProber::File final {
+  std::string path;
+  Tablebase::Signature signature;
+  bool has_lone_piece_rule{};
+  std::uint64_t num_positions{};
+  std::uint32_t num_blocks{};
+
+  // Guards Map; the members below are set by it.
+  std::once_flag map_flag;
+  const char* data{};
+  std::size_t size{};
+  bool is_mapped{};
+  bool is_valid{};
+  std::vector<char> buffer;
+
+  ~File() {
+#if defined(__unix__)
+    if (is_mapped) {
+      munmap(const_cast<char*>(data), size);
+    }
+#endif
+  }
+
+  // Reads the header; returns nullptr, if path is not a valid class file.
+  static std::unique_ptr<File> Open(const std::string& path);
+
+  // Maps the file and sets is_valid, if its contents match the header.
+  void Map();
+
+  std::uint64_t GetOffset(std::uint32_t block) const {
+    return Read<std::uint64_t>(data, kHeaderSize + 8 * block);
+  }
+  // Number of positions of block.
+  int GetBlockSize(std::uint32_t block) const {
+    return static_cast<int>(std::min<std::uint64_t>(
+        kBlockSize, num_positions - std::uint64_t{block} * kBlockSize));
+  }
+};
+
+std::unique_ptr<TablebaseProber::File> TablebaseProber::File::Open(
+    const std::string& path) {
+  std::ifstream stream{path, std::ios::binary};
+  char header[kHeaderSize];
+  if (!stream.read(header, sizeof(header)) ||
+      std::memcmp(header, kMagic, sizeof(kMagic)) ||
+      (Read<std::uint32_t>(header, 4) != kVersion) ||
+      (Read<std::uint32_t>(header, 8) != Config::kBoardSize) ||
+      (Read<std::uint32_t>(header, 36) != kBlockSize) ||
+      (Read<std::uint32_t>(header, 44) > 1)) {
+    return nullptr;
+  }
+  auto file = std::make_unique<File>();
+  file->path = path;
+  file->signature = Tablebase::Signature{
+      Read<std::int32_t>(header, 12), Read<std::int32_t>(header, 16),
+      Read<std::int32_t>(header, 20), Read<std::int32_t>(header, 24)};
+  file->num_positions = Read<std::uint64_t>(header, 28);
+  file->num_blocks = Read<std::uint32_t>(header, 40);
+  file->has_lone_piece_rule = Read<std::uint32_t>(header, 44);
+  if ((file->num_positions != Tablebase::GetSize(file->signature)) ||
+      (file->num_blocks !=
+       (file->num_positions + kBlockSize - 1) / kBlockSize)) {
+    return nullptr;
+  }
+  return file;
+}
+
+void TablebaseProber::File::Map() {
+#if defined(__unix__)
+  auto fd = open(path.c_str(), O_RDONLY);
+  struct stat status;
+  if ((fd >= 0) && (fstat(fd, &status) == 0) && (status.st_size > 0)) {
+    auto memory = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (memory != MAP_FAILED) {
+      data = static_cast<const char*>(memory);
+      size = status.st_size;
+      is_mapped = true;
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+#endif
+  if (!is_mapped) {
+    std::ifstream stream{path, std::ios::binary};
+    buffer.assign(std::istreambuf_iterator<char>{stream},
+                  std::istreambuf_iterator<char>{});
+    data = buffer.data();
+    size = buffer.size();
+  }
+  // The file may have changed since its header was read.
+  is_valid = (size >= kHeaderSize + 8 * (num_blocks + 1)) &&
+             (Read<std::uint64_t>(data, 28) == num_positions) &&
+             (Read<std::uint32_t>(data, 40) == num_blocks) &&
+             (Read<std::uint32_t>(data, 44) == has_lone_piece_rule) &&
+             (GetOffset(num_blocks) <= size);
+}
+
+void TablebaseProber::Compress(const Tablebase& tablebase,
+                               const std::string& directory) {
+  for (const auto& [signature, table] : tablebase.tables()) {
+    auto num_blocks = static_cast<std::uint32_t>(
+        (table.size() + kBlockSize - 1) / kBlockSize);
+    std::vector<std::string> blocks;
+    for (std::uint32_t block{}; block < num_blocks; ++block) {
+      auto begin = static_cast<std::size_t>(block) * kBlockSize;
+      auto size = std::min<std::size_t>(kBlockSize, table.size() - begin);
+      blocks.push_back(EncodeBlock(table.data() + begin,
+                                   static_cast<int>(size)));
+    }
+
+    std::string bytes{kMagic, sizeof(kMagic)};
+    Append(bytes, kVersion);
+    Append(bytes, static_cast<std::uint32_t>(Config::kBoardSize));
+    for (auto count : {signature.light_men, signature.light_kings,
+                       signature.dark_men, signature.dark_kings}) {
+      Append(bytes, static_cast<std::int32_t>(count));
+    }
+    Append(bytes, static_cast<std::uint64_t>(table.size()));
+    Append(bytes, static_cast<std::uint32_t>(kBlockSize));
+    Append(bytes, num_blocks);
+    Append(bytes,
+           static_cast<std::uint32_t>(tablebase.has_lone_piece_rule()));
+    std::uint64_t offset = kHeaderSize + 8 * (num_blocks + 1);
+    for (const auto& block : blocks) {
+      Append(bytes, offset);
+      offset += block.size();
+    }
+    Append(bytes, offset);
+    for (const auto& block : blocks) {
+      bytes += block;
+    }
+
+    // E.g. "L10D02.cstbz", or "L10D02.analysis.cstbz" without the
+    // lone-piece rule.
+    auto path = directory + "/" + signature.ToString() +
+                (tablebase.has_lone_piece_rule() ? "" : ".analysis") +
+                kExtension;
+    std::ofstream file{path, std::ios::binary};
+    file.write(bytes.data(), bytes.size());
+    if (!file) {
+      std::ostringstream oss;
+      oss << "(" << path << ")";
+      throw std::runtime_error{"Cannot write tablebase - " + oss.str()};
+    }
+  }
+}
+
+TablebaseProber::TablebaseProber(const std::string& directory,
+                                 std::size_t cache_size)
+    : shard_size_{std::max<std::size_t>(cache_size / kNumCacheShards, 1)} {
+  for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+    if (entry.path().extension() != kExtension) {
+      continue;
+    }
+    if (auto file = File::Open(entry.path().string())) {
+      auto signature = file->signature;
+      files_[file->has_lone_piece_rule][signature] = std::move(file);
+    }
+  }
+
+  // All classes of n pieces need to be present to probe any of them.
+  for (int rule{}; rule < 2; ++rule) {
+    const auto& files = files_[rule];
+    auto is_complete = [&files](int n) {
+      for (int lm{}; lm <= n; ++lm) {
+        for (int lk{}; lm + lk <= n; ++lk) {
+          for (int dm{}; lm + lk + dm <= n; ++dm) {
+            Tablebase::Signature signature{lm, lk, dm, n - lm - lk - dm};
+            if ((lm + lk > 0) && (lm + lk < n) && !files.count(signature)) {
+              return false;
+            }
+          }
+        }
+      }
+      return true;
+    };
+    for (int n{2}; is_complete(n); ++n) {
+      max_pieces_[rule] = n;
+    }
+  }
+}
+
+TablebaseProber::~TablebaseProber() = default;
+
+Tablebase::Value TablebaseProber::Probe(const Position& position) const {
+  if (position.jumper() != Position::kNoJumper) {
+    return Tablebase::kUnknown;
+  }
+  // files_ does not change after construction, so it is searched without
+  // a lock.
+  const auto& files = files_[position.has_lone_piece_rule()];
+  auto signature = Tablebase::Signature::Of(position.board());
+  auto it = files.find(signature);
+  if (it == files.end()) {
+    return Tablebase::kUnknown;
+  }
+  auto& file = *it->second;
+  // Only the first probe of a class maps its file; later ones do not wait.
+  std::call_once(file.map_flag, [&file] { file.Map(); });
+  if (!file.is_valid) {
+    return Tablebase::kUnknown;
+  }
+  auto index = Tablebase::ToIndex(signature, position);
+  if (index >= file.num_positions) {
+    return Tablebase::kUnknown;
+  }
+  auto block = GetBlock(file, static_cast<std::uint32_t>(index / kBlockSize));
+  if (!block) {
+    return Tablebase::kUnknown;
+  }
+  return Tablebase::AtNumSeqMoves(ToValue((*block)[index % kBlockSize]),
+                                  position.num_seq_moves());
+}
+
+std::shared_ptr<const TablebaseProber::Block> TablebaseProber::GetBlock(
+    const File& file, std::uint32_t block) const {
+  BlockKey key{&file, block};
+  auto& shard = cache_[GetShard(key)];
+  {
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    auto it = shard.blocks.find(key);
+    if (it != shard.blocks.end()) {
+      shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+      return it->second->second;
+    }
+  }
+
+  // A corrupt block, which runs past its size or falls short of it, is
+  // not cached, so every probe of it fails.
+  auto size = static_cast<std::size_t>(file.GetBlockSize(block));
+  auto begin = file.GetOffset(block);
+  auto end = file.GetOffset(block + 1);
+  if ((begin > end) || (end > file.size) || ((end - begin) % 2 != 0)) {
+    return nullptr;
+  }
+  auto decoded = std::make_shared<Block>();
+  decoded->reserve(size);
+  for (auto offset = begin; offset < end; offset += 2) {
+    auto symbol = static_cast<std::uint8_t>(file.data[offset]);
+    auto run = static_cast<std::size_t>(
+        static_cast<std::uint8_t>(file.data[offset + 1])) + 1;
+    if (decoded->size() + run > size) {
+      return nullptr;
+    }
+    decoded->insert(decoded->end(), run, symbol);
+  }
+  if (decoded->size() != size) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock{shard.mutex};
+  auto it = shard.blocks.find(key);
+  if (it != shard.blocks.end()) {
+    return it->second->second;
+  }
+  shard.lru.emplace_front(key, decoded);
+  shard.blocks[key] = shard.lru.begin();
+  while (shard.lru.size() > shard_size_) {
+    shard.blocks.erase(shard.lru.back().first);
+    shard.lru.pop_back();
+  }
+  return decoded;
+}
+
+}  // namespace checkers_style_game
@@ -0,0 +1,98 @@
+#ifndef SRC_TABLEBASE_PROBER_H_
+#define SRC_TABLEBASE_PROBER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "src/position.h"
+#include "src/tablebase.h"
+
+namespace checkers_style_game {
+
+// Probes compressed tablebases. Every material class is one file: a
+// header, the offsets of its blocks, and the blocks, which run-length
+// encode the values of kBlockSize consecutive indices, including their
+// number of sequential moves. Tables with and without the lone-piece rule
+// are told apart by their header and may share a directory. The prober
+// reads the headers on construction
+// and maps a file on the first probe of its class, once for all threads;
+// decompressed blocks are kept in LRU caches, which are sharded by block,
+// so that threads rarely wait for each other. Probes are safe from any
+// thread.
+class TablebaseProber final {
+ public:
+  static constexpr int kBlockSize = 4096;
+  static constexpr std::size_t kDefaultCacheSize = 1024;
+  static constexpr int kNumCacheShards = 16;
+
+  // Writes the classes of tablebase in the compressed format.
+  static void Compress(const Tablebase& tablebase,
+                       const std::string& directory);
+
+  // Lists the classes in directory by the headers of their files; files,
+  // whose header is not valid, are left out. Nothing gets mapped before a
+  // probe.
+  explicit TablebaseProber(const std::string& directory,
+                           std::size_t cache_size = kDefaultCacheSize);
+  ~TablebaseProber();
+
+  TablebaseProber(const TablebaseProber&) = delete;
+  TablebaseProber& operator=(const TablebaseProber&) = delete;
+
+  // Largest number of pieces, for which all classes are present with or
+  // without the lone-piece rule.
+  int max_pieces(bool has_lone_piece_rule = true) const {
+    return max_pieces_[has_lone_piece_rule];
+  }
+
+  // Value for the side to move at its number of sequential moves, as
+  // Tablebase::Probe returns it, from the tables of its rules; kUnknown for
+  // a position of a class, which is not present, or in the middle of a
+  // multi-jump.
+  Tablebase::Value Probe(const Position& position) const;
+
+ private:
+  struct File;
+  using Block = std::vector<std::uint8_t>;
+  using BlockKey = std::pair<const File*, std::uint32_t>;
+
+  struct BlockKeyHash final {
+    std::size_t operator()(const BlockKey& key) const {
+      return std::hash<const void*>{}(key.first) ^ (key.second * 0x9E3779B9u);
+    }
+  };
+
+  // Most recently used blocks first.
+  struct CacheShard final {
+    std::mutex mutex;
+    std::list<std::pair<BlockKey, std::shared_ptr<const Block>>> lru;
+    std::unordered_map<BlockKey, decltype(lru)::iterator, BlockKeyHash>
+        blocks;
+  };
+
+  // Returns nullptr, if the block does not decode to its size.
+  std::shared_ptr<const Block> GetBlock(const File& file,
+                                        std::uint32_t block) const;
+
+  // Indexed by whether the tables have the lone-piece rule.
+  std::array<std::map<Tablebase::Signature, std::unique_ptr<File>>, 2>
+      files_;
+  std::array<int, 2> max_pieces_{};
+
+  std::size_t shard_size_;
+  mutable std::array<CacheShard, kNumCacheShards> cache_;
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_TABLEBASE_PROBER_H_
@@ -0,0 +1,110 @@
+#include "src/thread_pool.h"
+
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace checkers_style_game {
+
+namespace {
+
+// Pool and queue index of the current worker thread, if any.
+thread_local const ThreadPool* current_pool{};
+thread_local int current_index{-1};
+
+}  // namespace
+
+ThreadPool::ThreadPool(int num_threads) {
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+  for (int i{}; i < num_threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (int i{}; i < num_threads; ++i) {
+    threads_.emplace_back([this, i] { Work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    is_stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Submit(Task task) {
+  auto index = (current_pool == this) ?
+      current_index :
+      static_cast<int>(next_queue_++ % queues_.size());
+  num_pending_.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock{queues_[index]->mutex};
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++num_queued_;
+  }
+  work_cv_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  done_cv_.wait(lock, [this] { return num_pending_.load() == 0; });
+}
+
+void ThreadPool::Work(int index) {
+  current_pool = this;
+  current_index = index;
+  for (;;) {
+    Task task;
+    if (TryPop(index, task) || TrySteal(index, task)) {
+      --num_queued_;
+      task();
+      if (num_pending_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        done_cv_.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock{mutex_};
+    work_cv_.wait(lock, [this] {
+      return is_stopping_ || (num_queued_.load() > 0);
+    });
+    if (is_stopping_ && (num_queued_.load() == 0)) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::TryPop(int index, Task& task) {
+  auto& queue = *queues_[index];
+  std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::TrySteal(int index, Task& task) {
+  auto num_queues = static_cast<int>(queues_.size());
+  for (int i{1}; i < num_queues; ++i) {
+    auto& queue = *queues_[(index + i) % num_queues];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace checkers_style_game
@@ -0,0 +1,59 @@
+#ifndef SRC_THREAD_POOL_H_
+#define SRC_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace checkers_style_game {
+
+// Work-stealing thread pool. Each worker owns a deque: tasks submitted from
+// a worker go to the back of its own deque and are popped from there (LIFO),
+// while idle workers steal from the front of the others' deques (FIFO).
+// Tasks submitted from other threads are spread round-robin.
+class ThreadPool final {
+ public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int size() const { return static_cast<int>(threads_.size()); }
+
+  void Submit(Task task);
+  // Blocks until all submitted tasks, including the ones they submitted,
+  // have run.
+  void Wait();
+
+ private:
+  struct Queue final {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void Work(int index);
+  bool TryPop(int index, Task& task);
+  bool TrySteal(int index, Task& task);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<int> num_queued_{0};
+  std::atomic<int> num_pending_{0};
+  std::atomic<unsigned> next_queue_{0};
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  bool is_stopping_{false};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_THREAD_POOL_H_
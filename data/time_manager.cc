@@ -0,0 +1,39 @@
+#include "src/time_manager.h"
+
+#include <algorithm>
+
+namespace checkers_style_game {
+
+namespace {
+
+// Moves, which the remaining time is spread over in sudden death.
+constexpr int kDefaultMovesToGo = 30;
+// The hard deadline allows this many times the soft one.
+constexpr int kHardFactor = 4;
+
+}  // namespace
+
+void TimeManager::Start(const Settings& settings) {
+  start_ = Clock::now();
+  is_limited_ = (settings.move_time > Duration::zero()) ||
+                (settings.time_left > Duration::zero());
+  if (!is_limited_) {
+    return;
+  }
+  constexpr Duration kMinLimit{1};
+  if (settings.move_time > Duration::zero()) {
+    soft_limit_ = hard_limit_ =
+        std::max(settings.move_time - settings.overhead, kMinLimit);
+    return;
+  }
+  auto available = std::max(settings.time_left - settings.overhead,
+                            kMinLimit);
+  auto moves_to_go = (settings.moves_to_go > 0) ?
+      settings.moves_to_go : kDefaultMovesToGo;
+  // The increment comes back after the move, so most of it may be spent.
+  auto base = available / moves_to_go + settings.increment * 3 / 4;
+  soft_limit_ = std::clamp(base, kMinLimit, available);
+  hard_limit_ = std::clamp(kHardFactor * base, kMinLimit, available);
+}
+
+}  // namespace checkers_style_game
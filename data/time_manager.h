@@ -0,0 +1,56 @@
+#ifndef SRC_TIME_MANAGER_H_
+#define SRC_TIME_MANAGER_H_
+
+#include <chrono>
+
+namespace checkers_style_game {
+
+// Per-move time allocation. The soft deadline is checked between search
+// iterations, i.e. no new iteration starts after it, while the hard
+// deadline aborts the running iteration.
+class TimeManager final {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Duration = std::chrono::milliseconds;
+
+  static constexpr Duration kDefaultOverhead{20};
+
+  // All zero means no time limit.
+  struct Settings final {
+    // Remaining time on the clock of the side to move.
+    Duration time_left{};
+    Duration increment{};
+    // Moves until the next time control, zero for sudden death.
+    int moves_to_go{};
+    // Fixed time for this move, which takes precedence over the clock.
+    Duration move_time{};
+    // Reserve for the latency outside of the search.
+    Duration overhead{kDefaultOverhead};
+  };
+
+  void Start(const Settings& settings);
+
+  bool is_limited() const { return is_limited_; }
+  Duration soft_limit() const { return soft_limit_; }
+  Duration hard_limit() const { return hard_limit_; }
+
+  Duration GetElapsed() const {
+    return std::chrono::duration_cast<Duration>(Clock::now() - start_);
+  }
+  bool IsSoftExpired() const {
+    return is_limited_ && (GetElapsed() >= soft_limit_);
+  }
+  bool IsHardExpired() const {
+    return is_limited_ && (GetElapsed() >= hard_limit_);
+  }
+
+ private:
+  Clock::time_point start_;
+  bool is_limited_{};
+  Duration soft_limit_{};
+  Duration hard_limit_{};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_TIME_MANAGER_H_
@@ -0,0 +1,200 @@
+#include "src/transposition_table.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "src/bitboard.h"
+#include "src/common.h"
+#include "src/move_list.h"
+
+namespace checkers_style_game {
+
+namespace {
+
+// Data layout, from the lowest bit: score (16), depth (8), bound (2),
+// generation (6), square (8), direction index plus one (3), is_take (1).
+constexpr int kScoreShift = 0;
+constexpr int kDepthShift = 16;
+constexpr int kBoundShift = 24;
+constexpr int kGenerationShift = 26;
+constexpr int kSquareShift = 32;
+constexpr int kDirectionShift = 40;
+constexpr int kTakeShift = 43;
+
+constexpr std::uint64_t kGenerationMask = 0x3F;
+
+#if defined(__linux__)
+constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+#endif
+
+std::uint64_t GetBits(std::uint64_t data, int shift, std::uint64_t mask) {
+  return (data >> shift) & mask;
+}
+
+}  // namespace
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) {
+  Resize(megabytes);
+}
+
+TranspositionTable::~TranspositionTable() { Deallocate(); }
+
+void TranspositionTable::Resize(std::size_t megabytes) {
+  std::size_t num_buckets{1};
+  while (2 * num_buckets * sizeof(Bucket) <= megabytes * 1024 * 1024) {
+    num_buckets *= 2;
+  }
+  if (num_buckets != num_buckets_) {
+    Deallocate();
+    Allocate(num_buckets);
+  } else {
+    Clear();
+  }
+}
+
+void TranspositionTable::Clear() {
+  std::memset(static_cast<void*>(buckets_), 0, num_buckets_ * sizeof(Bucket));
+  generation_.store(0, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::Probe(Key key, Entry& entry) const {
+  const auto& bucket = buckets_[key & (num_buckets_ - 1)];
+  for (const auto& slot : bucket.slots) {
+    auto data = slot.data.load(std::memory_order_relaxed);
+    auto check = slot.check.load(std::memory_order_relaxed);
+    if (((check ^ data) == key) && data) {
+      entry = Unpack(data);
+      return entry.bound != Bound::kNone;
+    }
+  }
+  return false;
+}
+
+void TranspositionTable::Store(Key key, const Entry& entry) {
+  auto& bucket = buckets_[key & (num_buckets_ - 1)];
+  auto generation = generation_.load(std::memory_order_relaxed);
+  // Overwrites the entry of the same position, otherwise the one, which is
+  // the least valuable by depth and age.
+  Slot* target{};
+  int target_value{};
+  auto to_store = entry;
+  for (auto& slot : bucket.slots) {
+    auto data = slot.data.load(std::memory_order_relaxed);
+    auto check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) == key) {
+      auto old = Unpack(data);
+      if ((entry.bound != Bound::kExact) && (entry.depth + 2 < old.depth) &&
+          (GetBits(data, kGenerationShift, kGenerationMask) ==
+           (generation & kGenerationMask))) {
+        return;
+      }
+      if (to_store.move.direction == MoveDirection::kUnset) {
+        to_store.move = old.move;
+      }
+      target = &slot;
+      break;
+    }
+    // Slots fill up in order, so the key cannot be further on.
+    if (!data) {
+      target = &slot;
+      break;
+    }
+    auto age = (generation - GetBits(data, kGenerationShift,
+                                     kGenerationMask)) & kGenerationMask;
+    auto value = static_cast<int>(GetBits(data, kDepthShift, 0xFF)) -
+                 8 * static_cast<int>(age);
+    if (!target || (value < target_value)) {
+      target = &slot;
+      target_value = value;
+    }
+  }
+  auto data = Pack(to_store, generation);
+  target->data.store(data, std::memory_order_relaxed);
+  target->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+std::uint64_t TranspositionTable::Pack(const Entry& entry,
+                                       std::uint8_t generation) {
+  auto depth = std::clamp(entry.depth, 0, 0xFF);
+  std::uint64_t direction{};
+  if (entry.move.direction != MoveDirection::kUnset) {
+    direction = BitBoard::Geometry::ToDirectionIndex(entry.move.direction) + 1;
+  }
+  return (static_cast<std::uint64_t>(static_cast<std::uint16_t>(entry.score))
+              << kScoreShift) |
+         (static_cast<std::uint64_t>(depth) << kDepthShift) |
+         (static_cast<std::uint64_t>(entry.bound) << kBoundShift) |
+         ((generation & kGenerationMask) << kGenerationShift) |
+         (static_cast<std::uint64_t>(entry.move.square) << kSquareShift) |
+         (direction << kDirectionShift) |
+         (static_cast<std::uint64_t>(entry.move.is_take) << kTakeShift);
+}
+
+TranspositionTable::Entry TranspositionTable::Unpack(std::uint64_t data) {
+  Entry entry;
+  entry.score = static_cast<std::int16_t>(GetBits(data, kScoreShift, 0xFFFF));
+  entry.depth = static_cast<int>(GetBits(data, kDepthShift, 0xFF));
+  entry.bound = static_cast<Bound>(GetBits(data, kBoundShift, 0x3));
+  auto direction = GetBits(data, kDirectionShift, 0x7);
+  if (direction) {
+    entry.move.square =
+        static_cast<std::uint8_t>(GetBits(data, kSquareShift, 0xFF));
+    entry.move.direction = BitBoard::kDirections[direction - 1];
+    entry.move.is_take = GetBits(data, kTakeShift, 0x1);
+  }
+  return entry;
+}
+
+void TranspositionTable::Allocate(std::size_t num_buckets) {
+  auto size = num_buckets * sizeof(Bucket);
+#if defined(__linux__)
+  // Anonymous mappings come zeroed and are committed lazily; transparent
+  // huge pages cut the TLB misses of random probes.
+  if (size >= kHugePageSize) {
+    auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory != MAP_FAILED) {
+      madvise(memory, size, MADV_HUGEPAGE);
+      buckets_ = static_cast<Bucket*>(memory);
+      num_buckets_ = num_buckets;
+      is_mapped_ = true;
+      return;
+    }
+  }
+#endif
+  auto memory = std::aligned_alloc(alignof(Bucket), size);
+  if (!memory) {
+    throw std::bad_alloc{};
+  }
+  buckets_ = static_cast<Bucket*>(memory);
+  num_buckets_ = num_buckets;
+  is_mapped_ = false;
+  Clear();
+}
+
+void TranspositionTable::Deallocate() {
+  if (!buckets_) {
+    return;
+  }
+#if defined(__linux__)
+  if (is_mapped_) {
+    munmap(buckets_, num_buckets_ * sizeof(Bucket));
+  } else {
+    std::free(buckets_);
+  }
+#else
+  std::free(buckets_);
+#endif
+  buckets_ = nullptr;
+  num_buckets_ = 0;
+}
+
+}  // namespace checkers_style_game
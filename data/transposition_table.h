@@ -0,0 +1,81 @@
+#ifndef SRC_TRANSPOSITION_TABLE_H_
+#define SRC_TRANSPOSITION_TABLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/move_list.h"
+
+namespace checkers_style_game {
+
+// Fixed-size hash table of search results, shared by any number of search
+// threads without locks. Entries are grouped into buckets of one cache line
+// each. Every entry keeps its data next to the key XOR-ed with the data, so
+// an entry torn by concurrent stores fails verification on probe and reads
+// as a miss instead of as a wrong result.
+class TranspositionTable final {
+ public:
+  using Key = std::uint64_t;
+
+  static constexpr std::size_t kDefaultMegabytes = 16;
+
+  enum class Bound : std::uint8_t { kNone, kExact, kLower, kUpper };
+
+  struct Entry final {
+    MoveRecord move;
+    int score{};
+    int depth{};
+    Bound bound{Bound::kNone};
+  };
+
+  explicit TranspositionTable(std::size_t megabytes = kDefaultMegabytes);
+  ~TranspositionTable();
+
+  TranspositionTable(const TranspositionTable&) = delete;
+  TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+  // Not safe while a search uses the table.
+  void Resize(std::size_t megabytes);
+  void Clear();
+
+  // Number of entries.
+  std::size_t size() const { return num_buckets_ * kBucketSize; }
+
+  // Ages the entries of previous searches, which get replaced first.
+  void NewSearch() { generation_.fetch_add(1, std::memory_order_relaxed); }
+
+  void Prefetch(Key key) const {
+    __builtin_prefetch(&buckets_[key & (num_buckets_ - 1)]);
+  }
+
+  bool Probe(Key key, Entry& entry) const;
+  void Store(Key key, const Entry& entry);
+
+ private:
+  static constexpr int kBucketSize = 4;
+
+  struct Slot final {
+    std::atomic<std::uint64_t> check;
+    std::atomic<std::uint64_t> data;
+  };
+
+  struct alignas(64) Bucket final {
+    Slot slots[kBucketSize];
+  };
+
+  static std::uint64_t Pack(const Entry& entry, std::uint8_t generation);
+  static Entry Unpack(std::uint64_t data);
+
+  void Allocate(std::size_t num_buckets);
+  void Deallocate();
+
+  Bucket* buckets_{};
+  std::size_t num_buckets_{};
+  bool is_mapped_{};
+  std::atomic<std::uint8_t> generation_{};
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_TRANSPOSITION_TABLE_H_
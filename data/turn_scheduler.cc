@@ -0,0 +1,47 @@
+#include "src/turn_scheduler.h"
+
+#include <algorithm>
+
+#include "src/engine.h"
+
+namespace checkers_style_game {
+
+TurnScheduler::~TurnScheduler() {
+  for (auto engine : engines_) {
+    engine->SetAutoPlay(true);
+  }
+}
+
+void TurnScheduler::Add(Engine& engine) {
+  if (std::find(engines_.begin(), engines_.end(), &engine) !=
+      engines_.end()) {
+    return;
+  }
+  engine.SetAutoPlay(false);
+  engines_.push_back(&engine);
+}
+
+void TurnScheduler::Remove(Engine& engine) {
+  auto it = std::find(engines_.begin(), engines_.end(), &engine);
+  if (it != engines_.end()) {
+    engines_.erase(it);
+    engine.SetAutoPlay(true);
+  }
+}
+
+int TurnScheduler::Step() {
+  int num_turns{};
+  for (auto engine : engines_) {
+    if (engine->StepComputer()) {
+      ++num_turns;
+    }
+  }
+  return num_turns;
+}
+
+void TurnScheduler::Run() {
+  while (Step() > 0) {
+  }
+}
+
+}  // namespace checkers_style_game
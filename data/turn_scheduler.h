@@ -0,0 +1,39 @@
+#ifndef SRC_TURN_SCHEDULER_H_
+#define SRC_TURN_SCHEDULER_H_
+
+#include <vector>
+
+#include "src/engine.h"
+
+namespace checkers_style_game {
+
+// Drives the computer turns of many games from one thread, one turn per
+// game and round. Added engines stop playing computer turns on their own
+// from within StartGame/Move/Take, see Engine::SetAutoPlay.
+class TurnScheduler final {
+ public:
+  TurnScheduler() = default;
+  ~TurnScheduler();
+
+  TurnScheduler(const TurnScheduler&) = delete;
+  TurnScheduler& operator=(const TurnScheduler&) = delete;
+
+  void Add(Engine& engine);
+  void Remove(Engine& engine);
+
+  int size() const { return static_cast<int>(engines_.size()); }
+  bool empty() const { return engines_.empty(); }
+
+  // Lets every engine play at most one computer turn. Returns the number
+  // of turns played.
+  int Step();
+  // Steps until no engine has a computer turn to play.
+  void Run();
+
+ private:
+  std::vector<Engine*> engines_;
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_TURN_SCHEDULER_H_
@@ -0,0 +1,101 @@
+#ifndef SRC_ZOBRIST_H_
+#define SRC_ZOBRIST_H_
+
+#include <array>
+#include <cstdint>
+
+#include "src/common.h"
+#include "src/geometry.h"
+
+namespace checkers_style_game {
+
+// Zobrist keys for a kSize x kSize board, generated at compile time. A
+// position key XORs the keys of every piece on its square, the side to
+// move, the bucket of the number of sequential moves, in the middle of a
+// multi-jump, the square of the jumping piece and, for the rules of
+// GameType::kAnalysis, a key of their own.
+template <int kSize>
+struct Zobrist final {
+  using Key = std::uint64_t;
+
+  static constexpr int kNumKinds = 4;
+  static constexpr int kSeqMovesPerBucket = 8;
+  static constexpr int kNumSeqBuckets = 16;
+
+  static constexpr int ToKind(Side side, Level level) {
+    return ((side == Side::kDark) ? 2 : 0) + ((level == Level::kKing) ? 1 : 0);
+  }
+
+  static constexpr Key GetPieceKey(Side side, Level level, int square) {
+    return kPieceKeys[ToKind(side, level)][square];
+  }
+  static constexpr Key GetSideKey(Side side) {
+    return (side == Side::kDark) ? kDarkToMoveKey : Key{};
+  }
+  static constexpr Key GetJumperKey(int square) {
+    return kJumperKeys[square];
+  }
+  static constexpr Key GetAnalysisKey() { return kAnalysisKey; }
+  static constexpr Key GetSeqMovesKey(int num_seq_moves) {
+    auto bucket = num_seq_moves / kSeqMovesPerBucket;
+    return kSeqMovesKeys[(bucket < kNumSeqBuckets) ?
+                             bucket : (kNumSeqBuckets - 1)];
+  }
+
+ private:
+  using PieceKeys = std::array<std::array<Key, Geometry<kSize>::kNumSquares>,
+                               kNumKinds>;
+  using SeqMovesKeys = std::array<Key, kNumSeqBuckets>;
+  using JumperKeys = std::array<Key, Geometry<kSize>::kNumSquares>;
+
+  // SplitMix64 output for the given stream position.
+  static constexpr Key Mix(Key index) {
+    Key z = (index + 1) * 0x9E3779B97F4A7C15ull + kSize;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  static constexpr PieceKeys MakePieceKeys() {
+    PieceKeys keys{};
+    Key index{};
+    for (auto& kind_keys : keys) {
+      for (auto& key : kind_keys) {
+        key = Mix(index++);
+      }
+    }
+    return keys;
+  }
+
+  static constexpr SeqMovesKeys MakeSeqMovesKeys() {
+    SeqMovesKeys keys{};
+    Key index{kNumKinds * Geometry<kSize>::kNumSquares + 1};
+    // The first bucket is left zero, so that fresh positions hash by
+    // placement and side to move only.
+    for (int i{1}; i < kNumSeqBuckets; ++i) {
+      keys[i] = Mix(index++);
+    }
+    return keys;
+  }
+
+  static constexpr JumperKeys MakeJumperKeys() {
+    JumperKeys keys{};
+    Key index{kNumKinds * Geometry<kSize>::kNumSquares + kNumSeqBuckets};
+    for (auto& key : keys) {
+      key = Mix(index++);
+    }
+    return keys;
+  }
+
+  static constexpr PieceKeys kPieceKeys = MakePieceKeys();
+  static constexpr Key kDarkToMoveKey =
+      Mix(kNumKinds * Geometry<kSize>::kNumSquares);
+  static constexpr SeqMovesKeys kSeqMovesKeys = MakeSeqMovesKeys();
+  static constexpr JumperKeys kJumperKeys = MakeJumperKeys();
+  static constexpr Key kAnalysisKey = Mix(
+      (kNumKinds + 1) * Geometry<kSize>::kNumSquares + kNumSeqBuckets);
+};
+
+}  // namespace checkers_style_game
+
+#endif  // SRC_ZOBRIST_H_